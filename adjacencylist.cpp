@@ -0,0 +1,180 @@
+#include "adjacencylist.h"
+#include "graph.h"
+#include <stdexcept>
+#include <algorithm>
+#include <functional>
+
+namespace Graphs
+{
+
+AdjacencyList::AdjacencyList() : m_offsets(1, 0), m_targets(), m_weights() { }
+
+AdjacencyList::AdjacencyList(Graph const& graph) : m_offsets(), m_targets(), m_weights()
+{
+    uint32_t size = graph.getSize();
+    m_offsets.reserve(size + 1);
+    m_offsets.push_back(0);
+    // The graph keeps its edge count, so the arrays are sized exactly up front.
+    m_targets.reserve(graph.getEdgesCount());
+    m_weights.reserve(graph.getEdgesCount());
+    for (Node::integral_type src = 0; src < size; ++src)
+    {
+        graph.forEachEdge(src, [this](Node::integral_type target, edge_weight_type weight)
+        {
+            m_targets.push_back(target);
+            m_weights.push_back(weight);
+        });
+        m_offsets.push_back(m_targets.size());
+    }
+}
+
+AdjacencyList::AdjacencyList(std::vector<offset_type>&& offsets, std::vector<Node::integral_type>&& targets,
+                             std::vector<edge_weight_type>&& weights) noexcept(false)
+    : m_offsets(std::move(offsets)), m_targets(std::move(targets)), m_weights(std::move(weights))
+{
+    if (m_offsets.empty() || m_offsets.front() != 0 || m_offsets.back() != m_targets.size()
+            || m_targets.size() != m_weights.size() || !std::is_sorted(m_offsets.begin(), m_offsets.end()))
+    {
+        throw std::invalid_argument("Malformed adjacency arrays");
+    }
+    uint32_t size = getSize();
+    if (std::any_of(m_targets.begin(), m_targets.end(), [size](Node::integral_type t) { return t >= size; }))
+    {
+        throw std::invalid_argument("Adjacency refers to a non-existing node");
+    }
+}
+
+uint32_t AdjacencyList::getSize() const noexcept
+{
+    return static_cast<uint32_t>(m_offsets.size() - 1);
+}
+
+AdjacencyList::offset_type AdjacencyList::getEdgesCount() const noexcept
+{
+    return m_targets.size();
+}
+
+uint32_t AdjacencyList::getDegree(Node::integral_type node) const noexcept
+{
+    return static_cast<uint32_t>(m_offsets[node + 1] - m_offsets[node]);
+}
+
+AdjacencyList::offset_type AdjacencyList::edgesBegin(Node::integral_type node) const noexcept
+{
+    return m_offsets[node];
+}
+
+AdjacencyList::offset_type AdjacencyList::edgesEnd(Node::integral_type node) const noexcept
+{
+    return m_offsets[node + 1];
+}
+
+Node::integral_type AdjacencyList::getTarget(offset_type edge) const noexcept
+{
+    return m_targets[edge];
+}
+
+edge_weight_type AdjacencyList::getWeight(offset_type edge) const noexcept
+{
+    return m_weights[edge];
+}
+
+Node::integral_type const* AdjacencyList::targetsBegin(Node::integral_type node) const noexcept
+{
+    return m_targets.data() + m_offsets[node];
+}
+
+Node::integral_type const* AdjacencyList::targetsEnd(Node::integral_type node) const noexcept
+{
+    return m_targets.data() + m_offsets[node + 1];
+}
+
+edge_weight_type const* AdjacencyList::weightsBegin(Node::integral_type node) const noexcept
+{
+    return m_weights.data() + m_offsets[node];
+}
+
+bool AdjacencyList::hasUniformWeights() const noexcept
+{
+    return std::adjacent_find(m_weights.begin(), m_weights.end(), std::not_equal_to<edge_weight_type>()) == m_weights.end();
+}
+
+edge_weight_type AdjacencyList::getMinWeight() const noexcept
+{
+    return m_weights.empty() ? 0 : *std::min_element(m_weights.begin(), m_weights.end());
+}
+
+edge_weight_type AdjacencyList::getMaxWeight() const noexcept
+{
+    return m_weights.empty() ? 0 : *std::max_element(m_weights.begin(), m_weights.end());
+}
+
+AdjacencyList AdjacencyList::transposed() const
+{
+    uint32_t size = getSize();
+    std::vector<offset_type> offsets(size + 1, 0);
+    for (auto&& target : m_targets)
+    {
+        ++offsets[target + 1];
+    }
+    for (uint32_t node = 0; node < size; ++node)
+    {
+        offsets[node + 1] += offsets[node];
+    }
+
+    std::vector<offset_type> cursor(offsets.begin(), offsets.end() - 1);
+    std::vector<Node::integral_type> targets(m_targets.size());
+    std::vector<edge_weight_type> weights(m_weights.size());
+    for (Node::integral_type src = 0; src < size; ++src)
+    {
+        for (offset_type edge = m_offsets[src]; edge < m_offsets[src + 1]; ++edge)
+        {
+            offset_type slot = cursor[m_targets[edge]]++;
+            targets[slot] = src;
+            weights[slot] = m_weights[edge];
+        }
+    }
+    return AdjacencyList{std::move(offsets), std::move(targets), std::move(weights)};
+}
+
+AdjacencyList AdjacencyList::symmetrized() const
+{
+    // Union of out- and in-neighbours without self loops; u -> v keeps its own weight, otherwise v -> u is used.
+    AdjacencyList reversed = transposed();
+    uint32_t size = getSize();
+    std::vector<offset_type> offsets;
+    std::vector<Node::integral_type> targets;
+    std::vector<edge_weight_type> weights;
+    offsets.reserve(size + 1);
+    offsets.push_back(0);
+    targets.reserve(getEdgesCount());
+    weights.reserve(getEdgesCount());
+    for (Node::integral_type node = 0; node < size; ++node)
+    {
+        offset_type out = edgesBegin(node);
+        offset_type in = reversed.edgesBegin(node);
+        while (out < edgesEnd(node) || in < reversed.edgesEnd(node))
+        {
+            bool takeOut = (in == reversed.edgesEnd(node))
+                    || (out < edgesEnd(node) && m_targets[out] <= reversed.m_targets[in]);
+            Node::integral_type target = takeOut ? m_targets[out] : reversed.m_targets[in];
+            edge_weight_type weight = takeOut ? m_weights[out] : reversed.m_weights[in];
+            if (takeOut && in < reversed.edgesEnd(node) && reversed.m_targets[in] == target)
+            {
+                ++in;
+            }
+            (takeOut ? out : in)++;
+            if (target != node)
+            {
+                targets.push_back(target);
+                weights.push_back(weight);
+            }
+        }
+        offsets.push_back(targets.size());
+    }
+    targets.shrink_to_fit();
+    weights.shrink_to_fit();
+    return AdjacencyList{std::move(offsets), std::move(targets), std::move(weights)};
+}
+
+}
@@ -0,0 +1,60 @@
+#ifndef ADJACENCYLIST_H
+#define ADJACENCYLIST_H
+
+#include <vector>
+#include <cstddef>
+#include "commontypes.hpp"
+
+namespace Graphs
+{
+
+// Forward declaration of Graph class
+class Graph;
+
+// Read-only compressed sparse row view of a Graph. Neighbours of every node are stored
+// contiguously and sorted by id, so traversals touch O(V + E) memory instead of O(V^2).
+class AdjacencyList
+{
+public:
+    using offset_type = std::size_t;
+
+private:
+    std::vector<offset_type> m_offsets;
+    std::vector<Node::integral_type> m_targets;
+    std::vector<edge_weight_type> m_weights;
+
+public:
+    AdjacencyList();
+    explicit AdjacencyList(Graph const& graph);
+    AdjacencyList(std::vector<offset_type>&& offsets, std::vector<Node::integral_type>&& targets,
+                  std::vector<edge_weight_type>&& weights) noexcept(false);
+    AdjacencyList(AdjacencyList const&) = default;
+    AdjacencyList(AdjacencyList&&) = default;
+    AdjacencyList& operator=(AdjacencyList const&) = default;
+    AdjacencyList& operator=(AdjacencyList&&) = default;
+    ~AdjacencyList() = default;
+
+    uint32_t getSize() const noexcept;
+    offset_type getEdgesCount() const noexcept;
+    uint32_t getDegree(Node::integral_type node) const noexcept;
+
+    offset_type edgesBegin(Node::integral_type node) const noexcept;
+    offset_type edgesEnd(Node::integral_type node) const noexcept;
+    Node::integral_type getTarget(offset_type edge) const noexcept;
+    edge_weight_type getWeight(offset_type edge) const noexcept;
+
+    Node::integral_type const* targetsBegin(Node::integral_type node) const noexcept;
+    Node::integral_type const* targetsEnd(Node::integral_type node) const noexcept;
+    edge_weight_type const* weightsBegin(Node::integral_type node) const noexcept;
+
+    bool hasUniformWeights() const noexcept;
+    edge_weight_type getMinWeight() const noexcept;
+    edge_weight_type getMaxWeight() const noexcept;
+
+    AdjacencyList transposed() const;
+    AdjacencyList symmetrized() const;
+};
+
+}
+
+#endif // ADJACENCYLIST_H
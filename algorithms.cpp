@@ -1,6 +1,7 @@
 #include "algorithms.h"
 #include "graph.h"
 #include "labeledgraph.h"
+#include "instrumentation.h"
 
 #include <queue>
 #include <stack>
@@ -35,7 +36,7 @@ bool depthFirstSearch(const Graph &graph, const Node &root, const Node &target)
     return depthFirstSearchImpl(graph, root, target);
 }
 
-bool depthFirstSearch(const LabeledGraph &graph, LabeledNode root, LabeledNode target) noexcept(false)
+bool depthFirstSearch(const LabeledGraph &graph, LabeledNode const& root, LabeledNode const& target) noexcept(false)
 {
     return depthFirstSearchImpl(graph.getRawGraph(), root.node, target.node);
 }
@@ -50,7 +51,7 @@ bool breadthFirstSearch(const Graph &graph, const Node &root, const Node &target
     return breadthFirstSearchImpl(graph, root, target);
 }
 
-bool breadthFirstSearch(const LabeledGraph &graph, LabeledNode root, LabeledNode target) noexcept(false)
+bool breadthFirstSearch(const LabeledGraph &graph, LabeledNode const& root, LabeledNode const& target) noexcept(false)
 {
     return breadthFirstSearchImpl(graph.getRawGraph(), root.node, target.node);
 }
@@ -65,7 +66,7 @@ int32_t findShortestPath(const Graph &graph, const Node &root, const Node &targe
     return findShortestPathImpl(graph, root, target);
 }
 
-int32_t findShortestPath(const LabeledGraph &graph, LabeledNode root, LabeledNode target) noexcept(false)
+int32_t findShortestPath(const LabeledGraph &graph, LabeledNode const& root, LabeledNode const& target) noexcept(false)
 {
     return findShortestPathImpl(graph.getRawGraph(), root.node, target.node);
 }
@@ -85,24 +86,30 @@ bool isConsistentImpl(const Graph &graph) noexcept(false)
     {
         throw std::invalid_argument("The graph has no nodes");
     }
+    GRAPHS_INSTRUMENT_SCOPE("Algorithms::isConsistent");
     Node root{0};
     std::vector<uint8_t> visited(graph.getSize(), 0);
+    GRAPHS_INSTRUMENT_COUNT(Allocations, 1);
     std::queue<Node> nodesQueue;
     for (auto&& connected : graph.getConnectedNodes(root))
     {
         nodesQueue.push(connected);
+        GRAPHS_INSTRUMENT_COUNT(QueuePushes, 1);
     }
     visited[root.id] = 1;
+    GRAPHS_INSTRUMENT_COUNT(NodesVisited, 1);
 
     while (!nodesQueue.empty())
     {
         Node node = nodesQueue.front();
         nodesQueue.pop();
+        GRAPHS_INSTRUMENT_COUNT(NodesVisited, 1);
         for (auto&& connected : graph.getConnectedNodes(node))
         {
             if (visited[connected.id] == 0)
             {
                 nodesQueue.push(connected);
+                GRAPHS_INSTRUMENT_COUNT(QueuePushes, 1);
             }
         }
         visited[node.id] = 1;
@@ -126,8 +133,11 @@ bool depthFirstSearchImpl(const Graph &graph, Node const& root, Node const& targ
     {
         throw std::invalid_argument("Root or target node does not exist in the graph");
     }
+    GRAPHS_INSTRUMENT_SCOPE("Algorithms::depthFirstSearch");
     std::vector<uint8_t> visited(graph.getSize(), 0);
+    GRAPHS_INSTRUMENT_COUNT(Allocations, 1);
     visited[root.id] = 1;
+    GRAPHS_INSTRUMENT_COUNT(NodesVisited, 1);
     if (root == target)
     {
         return true;
@@ -137,6 +147,7 @@ bool depthFirstSearchImpl(const Graph &graph, Node const& root, Node const& targ
     for (auto&& connected : graph.getConnectedNodes(root))
     {
         nodesQueue.push(connected);
+        GRAPHS_INSTRUMENT_COUNT(QueuePushes, 1);
     }
 
     bool found = false;
@@ -144,6 +155,7 @@ bool depthFirstSearchImpl(const Graph &graph, Node const& root, Node const& targ
     {
         Node node = nodesQueue.top();
         nodesQueue.pop();
+        GRAPHS_INSTRUMENT_COUNT(NodesVisited, 1);
         if (node == target)
         {
             found = true;
@@ -155,6 +167,7 @@ bool depthFirstSearchImpl(const Graph &graph, Node const& root, Node const& targ
             if (visited[connected.id] == 0)
             {
                 nodesQueue.push(connected);
+                GRAPHS_INSTRUMENT_COUNT(QueuePushes, 1);
             }
         }
         visited[node.id] = 1;
@@ -168,8 +181,11 @@ bool breadthFirstSearchImpl(const Graph &graph, Node const& root, Node const& ta
     {
         throw std::invalid_argument("Root or target node does not exist in the graph");
     }
+    GRAPHS_INSTRUMENT_SCOPE("Algorithms::breadthFirstSearch");
     std::vector<uint8_t> visited(graph.getSize(), 0);
+    GRAPHS_INSTRUMENT_COUNT(Allocations, 1);
     visited[root.id] = 1;
+    GRAPHS_INSTRUMENT_COUNT(NodesVisited, 1);
     if (root == target)
     {
         return true;
@@ -179,6 +195,7 @@ bool breadthFirstSearchImpl(const Graph &graph, Node const& root, Node const& ta
     for (auto&& connected : graph.getConnectedNodes(root))
     {
         nodesQueue.push(connected);
+        GRAPHS_INSTRUMENT_COUNT(QueuePushes, 1);
     }
 
     bool found = false;
@@ -186,6 +203,7 @@ bool breadthFirstSearchImpl(const Graph &graph, Node const& root, Node const& ta
     {
         Node node = nodesQueue.front();
         nodesQueue.pop();
+        GRAPHS_INSTRUMENT_COUNT(NodesVisited, 1);
         if (node == target)
         {
             found = true;
@@ -197,6 +215,7 @@ bool breadthFirstSearchImpl(const Graph &graph, Node const& root, Node const& ta
             if (visited[connected.id] == 0)
             {
                 nodesQueue.push(connected);
+                GRAPHS_INSTRUMENT_COUNT(QueuePushes, 1);
             }
         }
         visited[node.id] = 1;
@@ -210,8 +229,10 @@ int32_t findShortestPathImpl(const Graph &graph, Node const& root, Node const& t
     {
         throw std::invalid_argument("Root or target node does not exist in the graph");
     }
+    GRAPHS_INSTRUMENT_SCOPE("Algorithms::findShortestPath");
     std::vector<uint8_t> visited(graph.getSize(), 0);
     std::vector<edge_weight_type> weights(graph.getSize(), std::numeric_limits<edge_weight_type>::max());
+    GRAPHS_INSTRUMENT_COUNT(Allocations, 2);
     weights[root.id] = 0;
 
     std::queue<Node> nodesQueue;
@@ -219,8 +240,10 @@ int32_t findShortestPathImpl(const Graph &graph, Node const& root, Node const& t
     {
         weights[connected.id] = graph.getEdgeWeight(root, connected);
         nodesQueue.push(connected);
+        GRAPHS_INSTRUMENT_COUNT(QueuePushes, 1);
     }
     visited[root.id] = 1;
+    GRAPHS_INSTRUMENT_COUNT(NodesVisited, 1);
 
     while (!nodesQueue.empty())
     {
@@ -228,14 +251,18 @@ int32_t findShortestPathImpl(const Graph &graph, Node const& root, Node const& t
         nodesQueue.pop();
         if (visited[node.id] == 0)
         {
+            GRAPHS_INSTRUMENT_COUNT(NodesVisited, 1);
             for (auto&& connected : graph.getConnectedNodes(node))
             {
                 uint16_t updatedCapacity = weights[node.id] + graph.getEdgeWeight(node, connected);
                 if (updatedCapacity < weights[connected.id])
                 {
+                    // A label that was already set is being corrected: the node goes through the queue again.
+                    GRAPHS_INSTRUMENT_COUNT(QueueRepushes, weights[connected.id] != std::numeric_limits<edge_weight_type>::max() ? 1 : 0);
                     weights[connected.id] = updatedCapacity;
                     visited[connected.id] = 0;
                     nodesQueue.push(connected);
+                    GRAPHS_INSTRUMENT_COUNT(QueuePushes, 1);
                 }
             }
             visited[node.id] = 1;
@@ -0,0 +1,315 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "algorithms.h"
+#include "generators.h"
+#include "graph.h"
+#include "instrumentation.h"
+
+// graphs-benchmark [--generator er|rmat|grid|powerlaw] [--size N] [--degree D] [--queries Q]
+//                  [--max-weight W] [--seed S] [--output results.json]
+//                  [--statistics stats.json] [--trace trace.json]
+// The last two need a build with CONFIG+=instrumentation to contain anything.
+// Every measured operation is timed on its own; results are written as one JSON document.
+
+namespace
+{
+
+using clock_type = std::chrono::steady_clock;
+
+struct Settings
+{
+    std::string generator = "er";
+    uint32_t size = 2048;
+    uint32_t degree = 8;
+    uint32_t queries = 200;
+    int32_t maxWeight = 100;
+    uint64_t seed = 1;
+    std::string output;
+    std::string statistics;
+    std::string trace;
+};
+
+struct Result
+{
+    std::string name;
+    std::size_t operations;
+    double seconds;
+    double p50;
+    double p90;
+    double p99;
+    double max;
+    // How far the operation raised the process peak RSS; zero when it fit in memory touched before.
+    long peakRssGrowthKb;
+};
+
+// Process-wide high-water mark; it never goes down.
+long peakRssKb()
+{
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+double percentile(std::vector<double> const& sorted, double share)
+{
+    if (sorted.empty())
+    {
+        return 0.0;
+    }
+    std::size_t index = static_cast<std::size_t>(std::ceil(share * sorted.size())) - 1;
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+// Runs `operation(i)` for i in [0, count), timing each call; latencies are reported in microseconds.
+Result measure(std::string const& name, std::size_t count, std::function<void(std::size_t)> const& operation)
+{
+    std::vector<double> latencies;
+    latencies.reserve(count);
+    long peakBefore = peakRssKb();
+    clock_type::time_point started = clock_type::now();
+    for (std::size_t index = 0; index < count; ++index)
+    {
+        clock_type::time_point before = clock_type::now();
+        operation(index);
+        latencies.push_back(std::chrono::duration<double, std::micro>(clock_type::now() - before).count());
+    }
+    double seconds = std::chrono::duration<double>(clock_type::now() - started).count();
+    std::sort(latencies.begin(), latencies.end());
+    return Result{name, count, seconds, percentile(latencies, 0.50), percentile(latencies, 0.90), percentile(latencies, 0.99),
+                  latencies.empty() ? 0.0 : latencies.back(), peakRssKb() - peakBefore};
+}
+
+Graphs::Graph generate(Settings const& settings)
+{
+    Graphs::Generators::GeneratorOptions options;
+    options.seed = settings.seed;
+    options.minWeight = 1;
+    options.maxWeight = static_cast<Graphs::edge_weight_type>(settings.maxWeight);
+    if (settings.generator == "rmat")
+    {
+        uint32_t scale = static_cast<uint32_t>(std::ceil(std::log2(std::max<uint32_t>(settings.size, 2))));
+        return Graphs::Generators::rmat(scale, std::max<uint32_t>(settings.degree / 2, 1), options);
+    }
+    else if (settings.generator == "grid")
+    {
+        uint32_t side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(settings.size))));
+        return Graphs::Generators::grid(side, side, options, 0.05);
+    }
+    else if (settings.generator == "powerlaw")
+    {
+        return Graphs::Generators::powerLaw(settings.size, std::max<uint32_t>(settings.degree / 2, 1), options);
+    }
+    return Graphs::Generators::erdosRenyi(settings.size, static_cast<uint64_t>(settings.size) * settings.degree / 2, options);
+}
+
+void writeJson(std::ostream& out, Settings const& settings, Graphs::Graph const& graph, std::vector<Result> const& results)
+{
+    out << "{\n  \"generator\": \"" << settings.generator << "\",\n  \"nodes\": " << graph.getSize()
+        << ",\n  \"degree\": " << settings.degree << ",\n  \"queries\": " << settings.queries
+        << ",\n  \"seed\": " << settings.seed << ",\n  \"peak_rss_kb\": " << peakRssKb() << ",\n  \"results\": [\n";
+    for (std::size_t index = 0; index < results.size(); ++index)
+    {
+        Result const& result = results[index];
+        out << "    {\"name\": \"" << result.name << "\", \"operations\": " << result.operations
+            << ", \"seconds\": " << result.seconds
+            << ", \"throughput\": " << (result.seconds > 0 ? result.operations / result.seconds : 0.0)
+            << ", \"p50_us\": " << result.p50 << ", \"p90_us\": " << result.p90 << ", \"p99_us\": " << result.p99
+            << ", \"max_us\": " << result.max << ", \"peak_rss_growth_kb\": " << result.peakRssGrowthKb << "}"
+            << (index + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+}
+
+// Parses a decimal option value in [minimum, maximum]; std::stoull alone would accept "-1" and trailing junk.
+uint64_t parseNumber(std::string const& option, std::string const& value, uint64_t minimum, uint64_t maximum)
+{
+    std::size_t parsed = 0;
+    uint64_t number = 0;
+    if (!value.empty() && value[0] >= '0' && value[0] <= '9')
+    {
+        try
+        {
+            number = std::stoull(value, &parsed);
+        }
+        catch (std::out_of_range&)
+        {
+            parsed = 0;
+        }
+    }
+    if (parsed == 0 || parsed != value.size() || number < minimum || number > maximum)
+    {
+        throw std::invalid_argument(option + " expects a number from " + std::to_string(minimum) + " to "
+                                    + std::to_string(maximum) + ", got '" + value + "'");
+    }
+    return number;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    constexpr uint64_t maxCount = std::numeric_limits<uint32_t>::max();
+    Settings settings;
+    try
+    {
+        for (int i = 1; i < argc; i += 2)
+        {
+            std::string option = argv[i];
+            if (i + 1 >= argc)
+            {
+                throw std::invalid_argument("Missing value for " + option);
+            }
+            std::string value = argv[i + 1];
+            if (option == "--generator")
+            {
+                if (value != "er" && value != "rmat" && value != "grid" && value != "powerlaw")
+                {
+                    throw std::invalid_argument("Unknown generator " + value);
+                }
+                settings.generator = value;
+            }
+            else if (option == "--size")
+            {
+                settings.size = static_cast<uint32_t>(parseNumber(option, value, 1, maxCount));
+            }
+            else if (option == "--degree")
+            {
+                settings.degree = static_cast<uint32_t>(parseNumber(option, value, 1, maxCount));
+            }
+            else if (option == "--queries")
+            {
+                settings.queries = static_cast<uint32_t>(parseNumber(option, value, 1, maxCount));
+            }
+            else if (option == "--max-weight")
+            {
+                // Weights are drawn from [1, W] and stored as edge_weight_type.
+                settings.maxWeight = static_cast<int32_t>(parseNumber(option, value, 1, std::numeric_limits<Graphs::edge_weight_type>::max()));
+            }
+            else if (option == "--seed")
+            {
+                settings.seed = parseNumber(option, value, 0, std::numeric_limits<uint64_t>::max());
+            }
+            else if (option == "--output")
+            {
+                settings.output = value;
+            }
+            else if (option == "--statistics")
+            {
+                settings.statistics = value;
+            }
+            else if (option == "--trace")
+            {
+                settings.trace = value;
+            }
+            else
+            {
+                throw std::invalid_argument("Unknown option " + option);
+            }
+        }
+    }
+    catch (std::invalid_argument& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cerr << "usage: " << argv[0] << " [--generator er|rmat|grid|powerlaw] [--size N] [--degree D] [--queries Q]"
+                  << " [--max-weight W] [--seed S] [--output results.json] [--statistics stats.json] [--trace trace.json]"
+                  << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        Graphs::Instrumentation::setTracingEnabled(!settings.trace.empty());
+        std::vector<Result> results;
+        Graphs::Graph graph;
+        results.push_back(measure("generate", 1, [&](std::size_t) { graph = generate(settings); }));
+        uint32_t size = graph.getSize();
+
+        std::mt19937_64 random(settings.seed);
+        std::uniform_int_distribution<uint32_t> pickNode(0, size - 1);
+        std::vector<Graphs::Node> roots;
+        std::vector<Graphs::Node> targets;
+        for (uint32_t query = 0; query < settings.queries; ++query)
+        {
+            roots.push_back(Graphs::Node{pickNode(random)});
+            targets.push_back(Graphs::Node{pickNode(random)});
+        }
+
+        std::string xml;
+        results.push_back(measure("serialize", 1, [&](std::size_t) { xml = graph.serialize(); }));
+        results.push_back(measure("fromXml", 1, [&](std::size_t)
+        {
+            Graphs::Graph parsed;
+            parsed.fromXml(xml);
+        }));
+
+        Graphs::Graph mutated = graph;
+        results.push_back(measure("insertEdge", settings.queries, [&](std::size_t index)
+        {
+            mutated.insertEdge(roots[index], targets[index], static_cast<Graphs::edge_weight_type>(1), Graphs::EdgeDirection::Directed);
+        }));
+        results.push_back(measure("getConnectedNodes", settings.queries, [&](std::size_t index)
+        {
+            volatile std::size_t degree = graph.getConnectedNodes(roots[index]).size();
+            (void)degree;
+        }));
+        results.push_back(measure("depthFirstSearch", settings.queries, [&](std::size_t index)
+        {
+            volatile bool found = Graphs::Algorithms::depthFirstSearch(graph, roots[index], targets[index]);
+            (void)found;
+        }));
+        results.push_back(measure("breadthFirstSearch", settings.queries, [&](std::size_t index)
+        {
+            volatile bool found = Graphs::Algorithms::breadthFirstSearch(graph, roots[index], targets[index]);
+            (void)found;
+        }));
+        results.push_back(measure("findShortestPath", settings.queries, [&](std::size_t index)
+        {
+            volatile int32_t distance = Graphs::Algorithms::findShortestPath(graph, roots[index], targets[index]);
+            (void)distance;
+        }));
+        results.push_back(measure("isConsistent", std::max<uint32_t>(settings.queries / 20, 1), [&](std::size_t)
+        {
+            volatile bool consistent = Graphs::Algorithms::isConsistent(graph);
+            (void)consistent;
+        }));
+
+        if (settings.output.empty())
+        {
+            writeJson(std::cout, settings, graph, results);
+        }
+        else
+        {
+            std::ofstream file(settings.output);
+            writeJson(file, settings, graph, results);
+        }
+        if (!settings.statistics.empty())
+        {
+            std::ofstream file(settings.statistics);
+            Graphs::Instrumentation::writeStatistics(file, Graphs::Instrumentation::takeSnapshot());
+        }
+        if (!settings.trace.empty())
+        {
+            std::ofstream file(settings.trace);
+            Graphs::Instrumentation::writeChromeTrace(file);
+        }
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
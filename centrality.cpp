@@ -0,0 +1,258 @@
+#include "centrality.h"
+#include "adjacencylist.h"
+#include "graph.h"
+#include "labeledgraph.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <vector>
+
+#include <stdexcept>
+#include <limits>
+
+namespace Graphs
+{
+
+namespace Algorithms
+{
+
+static std::vector<double> betweennessCentralityImpl(AdjacencyList const& adjacency, std::vector<Node::integral_type> const& sources,
+                                                     double scale, unsigned threads) noexcept(false);
+static std::vector<Node::integral_type> samplePivots(uint32_t size, uint32_t pivots, uint64_t seed) noexcept(false);
+
+std::vector<double> betweennessCentrality(Graph const& graph, unsigned threads) noexcept(false)
+{
+    std::vector<Node::integral_type> sources(graph.getSize());
+    std::iota(sources.begin(), sources.end(), 0);
+    return betweennessCentralityImpl(AdjacencyList{graph}, sources, 1.0, threads);
+}
+
+std::vector<double> betweennessCentrality(LabeledGraph const& graph, unsigned threads) noexcept(false)
+{
+    return betweennessCentrality(graph.getRawGraph(), threads);
+}
+
+std::vector<double> approximateBetweennessCentrality(Graph const& graph, uint32_t pivots, uint64_t seed, unsigned threads) noexcept(false)
+{
+    std::vector<Node::integral_type> sources = samplePivots(graph.getSize(), pivots, seed);
+    double scale = static_cast<double>(graph.getSize()) / sources.size();
+    return betweennessCentralityImpl(AdjacencyList{graph}, sources, scale, threads);
+}
+
+std::vector<double> approximateBetweennessCentrality(LabeledGraph const& graph, uint32_t pivots, uint64_t seed, unsigned threads) noexcept(false)
+{
+    return approximateBetweennessCentrality(graph.getRawGraph(), pivots, seed, threads);
+}
+
+// =====================================================
+//                   IMPLEMENTATION
+// =====================================================
+
+namespace
+{
+
+// Per-worker state, allocated once and reused for every source the worker processes.
+struct BrandesScratch
+{
+    std::vector<double> centrality;
+    std::vector<double> sigma;
+    std::vector<double> delta;
+    std::vector<int64_t> distance;
+    std::vector<Node::integral_type> order;
+    std::vector<Node::integral_type> queue;
+
+    explicit BrandesScratch(uint32_t size) : centrality(size, 0.0), sigma(size, 0.0), delta(size, 0.0),
+                                             distance(size, -1), order(), queue()
+    {
+        order.reserve(size);
+        queue.reserve(size);
+    }
+};
+
+void resetScratch(BrandesScratch& scratch)
+{
+    for (auto&& node : scratch.order)
+    {
+        scratch.sigma[node] = 0.0;
+        scratch.delta[node] = 0.0;
+        scratch.distance[node] = -1;
+    }
+    scratch.order.clear();
+}
+
+void countPathsByHops(AdjacencyList const& adjacency, Node::integral_type source, BrandesScratch& scratch)
+{
+    scratch.queue.clear();
+    scratch.queue.push_back(source);
+    scratch.distance[source] = 0;
+    scratch.sigma[source] = 1.0;
+    for (std::size_t head = 0; head < scratch.queue.size(); ++head)
+    {
+        Node::integral_type node = scratch.queue[head];
+        scratch.order.push_back(node);
+        for (auto it = adjacency.targetsBegin(node); it != adjacency.targetsEnd(node); ++it)
+        {
+            if (scratch.distance[*it] < 0)
+            {
+                scratch.distance[*it] = scratch.distance[node] + 1;
+                scratch.queue.push_back(*it);
+            }
+            if (scratch.distance[*it] == scratch.distance[node] + 1)
+            {
+                scratch.sigma[*it] += scratch.sigma[node];
+            }
+        }
+    }
+}
+
+void countPathsByWeights(AdjacencyList const& adjacency, Node::integral_type source, BrandesScratch& scratch)
+{
+    using entry_type = std::pair<int64_t, Node::integral_type>;
+    std::priority_queue<entry_type, std::vector<entry_type>, std::greater<entry_type>> heap;
+    scratch.distance[source] = 0;
+    scratch.sigma[source] = 1.0;
+    heap.emplace(0, source);
+    // delta doubles as the "settled" flag while paths are counted; it is cleared before accumulation.
+    while (!heap.empty())
+    {
+        entry_type top = heap.top();
+        heap.pop();
+        Node::integral_type node = top.second;
+        if (scratch.delta[node] != 0.0 || top.first != scratch.distance[node])
+        {
+            continue;
+        }
+        scratch.delta[node] = 1.0;
+        scratch.order.push_back(node);
+        edge_weight_type const* weight = adjacency.weightsBegin(node);
+        for (auto it = adjacency.targetsBegin(node); it != adjacency.targetsEnd(node); ++it, ++weight)
+        {
+            int64_t candidate = scratch.distance[node] + *weight;
+            if (scratch.distance[*it] < 0 || candidate < scratch.distance[*it])
+            {
+                scratch.distance[*it] = candidate;
+                scratch.sigma[*it] = scratch.sigma[node];
+                heap.emplace(candidate, *it);
+            }
+            else if (candidate == scratch.distance[*it])
+            {
+                scratch.sigma[*it] += scratch.sigma[node];
+            }
+        }
+    }
+    for (auto&& node : scratch.order)
+    {
+        scratch.delta[node] = 0.0;
+    }
+}
+
+// Dependencies are accumulated over successors in reverse settle order, so no predecessor lists are needed.
+void accumulateDependencies(AdjacencyList const& adjacency, Node::integral_type source, bool byHops, BrandesScratch& scratch)
+{
+    for (auto node = scratch.order.rbegin(); node != scratch.order.rend(); ++node)
+    {
+        double dependency = 0.0;
+        edge_weight_type const* weight = adjacency.weightsBegin(*node);
+        for (auto it = adjacency.targetsBegin(*node); it != adjacency.targetsEnd(*node); ++it, ++weight)
+        {
+            int64_t step = byHops ? 1 : *weight;
+            if (scratch.distance[*it] == scratch.distance[*node] + step)
+            {
+                dependency += (1.0 + scratch.delta[*it]) / scratch.sigma[*it];
+            }
+        }
+        scratch.delta[*node] = scratch.sigma[*node] * dependency;
+        if (*node != source)
+        {
+            scratch.centrality[*node] += scratch.delta[*node];
+        }
+    }
+}
+
+}
+
+std::vector<double> betweennessCentralityImpl(AdjacencyList const& adjacency, std::vector<Node::integral_type> const& sources,
+                                              double scale, unsigned threads) noexcept(false)
+{
+    uint32_t size = adjacency.getSize();
+    bool byHops = adjacency.hasUniformWeights();
+    if (!byHops && adjacency.getMinWeight() <= 0)
+    {
+        throw std::invalid_argument("Weighted betweenness centrality requires positive edge weights");
+    }
+
+    unsigned workers = Parallel::threadsCount(threads);
+    std::vector<std::unique_ptr<BrandesScratch>> scratches(workers);
+    Parallel::forEach(sources.size(), workers, [&](unsigned worker, std::size_t index)
+    {
+        if (!scratches[worker])
+        {
+            scratches[worker].reset(new BrandesScratch(size));
+        }
+        BrandesScratch& scratch = *scratches[worker];
+        resetScratch(scratch);
+        if (byHops)
+        {
+            countPathsByHops(adjacency, sources[index], scratch);
+        }
+        else
+        {
+            countPathsByWeights(adjacency, sources[index], scratch);
+        }
+        accumulateDependencies(adjacency, sources[index], byHops, scratch);
+    }, 1);
+
+    std::vector<double> centrality(size, 0.0);
+    for (auto&& scratch : scratches)
+    {
+        if (scratch)
+        {
+            for (uint32_t node = 0; node < size; ++node)
+            {
+                centrality[node] += scratch->centrality[node];
+            }
+        }
+    }
+    if (scale != 1.0)
+    {
+        for (auto&& value : centrality)
+        {
+            value *= scale;
+        }
+    }
+    return centrality;
+}
+
+std::vector<Node::integral_type> samplePivots(uint32_t size, uint32_t pivots, uint64_t seed) noexcept(false)
+{
+    if (size == 0)
+    {
+        throw std::invalid_argument("The graph has no nodes");
+    }
+    else if (pivots == 0)
+    {
+        throw std::invalid_argument("At least one pivot is required");
+    }
+    pivots = std::min(pivots, size);
+
+    // Partial Fisher-Yates shuffle: the first `pivots` entries become a uniform sample without replacement.
+    std::vector<Node::integral_type> nodes(size);
+    std::iota(nodes.begin(), nodes.end(), 0);
+    std::mt19937_64 generator(seed);
+    for (uint32_t i = 0; i < pivots; ++i)
+    {
+        std::uniform_int_distribution<uint32_t> pick(i, size - 1);
+        std::swap(nodes[i], nodes[pick(generator)]);
+    }
+    nodes.resize(pivots);
+    return nodes;
+}
+
+}
+
+}
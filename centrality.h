@@ -0,0 +1,32 @@
+#ifndef CENTRALITY_H
+#define CENTRALITY_H
+
+#include <vector>
+#include "commontypes.hpp"
+
+namespace Graphs
+{
+
+// Forward declaration of Graph class
+class Graph;
+// Forward declaration of LabeledGraph class
+class LabeledGraph;
+
+namespace Algorithms
+{
+
+// Brandes betweenness centrality over ordered (source, target) pairs. Graphs whose edges all share
+// one weight are traversed with BFS, others with Dijkstra (weights must then be positive).
+// threads == 0 uses all hardware threads.
+std::vector<double> betweennessCentrality(Graph const& graph, unsigned threads = 0) noexcept(false);
+std::vector<double> betweennessCentrality(LabeledGraph const& graph, unsigned threads = 0) noexcept(false);
+
+// Same estimate from `pivots` uniformly sampled sources, scaled by size / pivots.
+std::vector<double> approximateBetweennessCentrality(Graph const& graph, uint32_t pivots, uint64_t seed = 0, unsigned threads = 0) noexcept(false);
+std::vector<double> approximateBetweennessCentrality(LabeledGraph const& graph, uint32_t pivots, uint64_t seed = 0, unsigned threads = 0) noexcept(false);
+
+}
+
+}
+
+#endif // CENTRALITY_H
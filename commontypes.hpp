@@ -3,12 +3,15 @@
 
 #include <cstdint>
 #include <string>
+#include <limits>
 
 namespace Graphs
 {
 
 using edge_weight_type = int16_t;
 
+constexpr int64_t unreachableDistance = std::numeric_limits<int64_t>::max();
+
 enum class EdgeDirection : uint8_t
 {
     Directed,
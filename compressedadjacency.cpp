@@ -0,0 +1,240 @@
+#include "compressedadjacency.h"
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+
+namespace Graphs
+{
+
+constexpr unsigned CompressedAdjacency::indexOffsetBits;
+constexpr uint64_t CompressedAdjacency::largeDegree;
+
+// Bytes past the last row that readGroup() may touch: up to three unused one byte slots, each loaded as four bytes.
+constexpr std::size_t decodePadding = 7;
+
+static unsigned getDeltaLength(uint32_t value) noexcept
+{
+    return value < (1U << 8) ? 1 : value < (1U << 16) ? 2 : value < (1U << 24) ? 3 : 4;
+}
+
+static void writeVarint(std::vector<uint8_t>& bytes, uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        bytes.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back(static_cast<uint8_t>(value));
+}
+
+CompressedAdjacency::CompressedAdjacency() : CompressedAdjacency(AdjacencyList{}) { }
+
+CompressedAdjacency::CompressedAdjacency(Graph const& graph) : CompressedAdjacency(AdjacencyList{graph}) { }
+
+CompressedAdjacency::CompressedAdjacency(AdjacencyList const& adjacency)
+    : m_index(), m_bytes(), m_dictionary(), m_edgesCount(adjacency.getEdgesCount()), m_targetBytes(0), m_weightBytes(0), m_weightBits(0)
+{
+    uint32_t size = adjacency.getSize();
+    for (Node::integral_type node = 0; node < size; ++node)
+    {
+        m_dictionary.insert(m_dictionary.end(), adjacency.weightsBegin(node), adjacency.weightsBegin(node) + adjacency.getDegree(node));
+    }
+    std::sort(m_dictionary.begin(), m_dictionary.end());
+    m_dictionary.erase(std::unique(m_dictionary.begin(), m_dictionary.end()), m_dictionary.end());
+    m_dictionary.shrink_to_fit();
+    while ((std::size_t{1} << m_weightBits) < m_dictionary.size())
+    {
+        ++m_weightBits;
+    }
+
+    m_index.reserve(size + 1);
+    m_bytes.reserve(adjacency.getEdgesCount() * 2 + size);
+    for (Node::integral_type node = 0; node < size; ++node)
+    {
+        if (m_bytes.size() >> indexOffsetBits != 0)
+        {
+            throw std::length_error("Compressed adjacency exceeds the row index range");
+        }
+        uint32_t degree = adjacency.getDegree(node);
+        m_index.push_back(m_bytes.size() | (std::min<uint64_t>(degree, largeDegree) << indexOffsetBits));
+        if (degree >= largeDegree)
+        {
+            writeVarint(m_bytes, degree);
+        }
+
+        std::size_t codesBegin = m_bytes.size();
+        m_bytes.resize(codesBegin + (static_cast<std::size_t>(degree) * m_weightBits + 7) / 8, 0);
+        edge_weight_type const* weights = adjacency.weightsBegin(node);
+        for (uint32_t index = 0; index < degree; ++index)
+        {
+            uint32_t code = static_cast<uint32_t>(std::lower_bound(m_dictionary.begin(), m_dictionary.end(), weights[index]) - m_dictionary.begin());
+            std::size_t bit = static_cast<std::size_t>(index) * m_weightBits;
+            for (unsigned written = 0; written < m_weightBits; ++written, ++bit)
+            {
+                m_bytes[codesBegin + bit / 8] |= static_cast<uint8_t>(((code >> written) & 1U) << (bit % 8));
+            }
+        }
+        m_weightBytes += m_bytes.size() - codesBegin;
+
+        std::size_t targetsBegin = m_bytes.size();
+        std::size_t lengthsBegin = m_bytes.size();
+        m_bytes.resize(lengthsBegin + (degree + 3) / 4, 0);
+        Node::integral_type previous = node;
+        for (uint32_t index = 0; index < degree; ++index)
+        {
+            Node::integral_type target = adjacency.targetsBegin(node)[index];
+            uint32_t delta = target - previous;
+            if (index == 0)
+            {
+                int64_t signedDelta = static_cast<int64_t>(target) - static_cast<int64_t>(node);
+                delta = static_cast<uint32_t>(signedDelta < 0 ? (-signedDelta) * 2 - 1 : signedDelta * 2);
+            }
+            unsigned length = getDeltaLength(delta);
+            m_bytes[lengthsBegin + index / 4] |= static_cast<uint8_t>((length - 1) << (index % 4 * 2));
+            for (unsigned byte = 0; byte < length; ++byte)
+            {
+                m_bytes.push_back(static_cast<uint8_t>(delta >> (byte * 8)));
+            }
+            previous = target;
+        }
+        m_targetBytes += m_bytes.size() - targetsBegin;
+    }
+    m_index.push_back(m_bytes.size());
+    m_bytes.resize(m_bytes.size() + decodePadding, 0);
+    m_bytes.shrink_to_fit();
+}
+
+uint32_t CompressedAdjacency::getSize() const noexcept
+{
+    return static_cast<uint32_t>(m_index.size() - 1);
+}
+
+CompressedAdjacency::offset_type CompressedAdjacency::getEdgesCount() const noexcept
+{
+    return m_edgesCount;
+}
+
+uint32_t CompressedAdjacency::getDegree(Node::integral_type node) const noexcept
+{
+    uint32_t degree;
+    openRow(node, degree);
+    return degree;
+}
+
+unsigned CompressedAdjacency::getWeightBits() const noexcept
+{
+    return m_weightBits;
+}
+
+std::vector<edge_weight_type> const& CompressedAdjacency::getDictionary() const noexcept
+{
+    return m_dictionary;
+}
+
+edge_weight_type CompressedAdjacency::getMinWeight() const noexcept
+{
+    return m_dictionary.empty() ? 0 : m_dictionary.front();
+}
+
+AdjacencyList CompressedAdjacency::decompress() const
+{
+    std::vector<AdjacencyList::offset_type> offsets;
+    std::vector<Node::integral_type> targets;
+    std::vector<edge_weight_type> weights;
+    offsets.reserve(m_index.size());
+    targets.reserve(m_edgesCount);
+    weights.reserve(m_edgesCount);
+    offsets.push_back(0);
+    for (Node::integral_type node = 0; node < getSize(); ++node)
+    {
+        forEachEdge(node, [&targets, &weights](Node::integral_type target, edge_weight_type weight)
+        {
+            targets.push_back(target);
+            weights.push_back(weight);
+        });
+        offsets.push_back(targets.size());
+    }
+    return AdjacencyList{std::move(offsets), std::move(targets), std::move(weights)};
+}
+
+MemoryUsage CompressedAdjacency::memoryUsage() const noexcept
+{
+    // Large degree prefixes and padding are accounted with the row index as indexing overhead.
+    return MemoryUsage{m_targetBytes, m_weightBytes + m_dictionary.capacity() * sizeof(edge_weight_type), 0,
+                       sizeof(CompressedAdjacency) + m_index.capacity() * sizeof(uint64_t)
+                       + m_bytes.capacity() - m_targetBytes - m_weightBytes};
+}
+
+namespace Algorithms
+{
+
+std::vector<int64_t> breadthFirstDistances(CompressedAdjacency const& adjacency, Node const& root) noexcept(false)
+{
+    if (root.id >= adjacency.getSize())
+    {
+        throw std::invalid_argument("Root node does not exist in the graph");
+    }
+    std::vector<int64_t> distances(adjacency.getSize(), unreachableDistance);
+    std::vector<Node::integral_type> frontier;
+    frontier.reserve(adjacency.getSize());
+    distances[root.id] = 0;
+    frontier.push_back(root.id);
+    for (std::size_t head = 0; head < frontier.size(); ++head)
+    {
+        Node::integral_type node = frontier[head];
+        int64_t next = distances[node] + 1;
+        adjacency.forEachTarget(node, [&distances, &frontier, next](Node::integral_type target)
+        {
+            if (distances[target] == unreachableDistance)
+            {
+                distances[target] = next;
+                frontier.push_back(target);
+            }
+        });
+    }
+    return distances;
+}
+
+std::vector<int64_t> shortestDistances(CompressedAdjacency const& adjacency, Node const& root) noexcept(false)
+{
+    if (root.id >= adjacency.getSize())
+    {
+        throw std::invalid_argument("Root node does not exist in the graph");
+    }
+    if (adjacency.getMinWeight() < 0)
+    {
+        throw std::invalid_argument("Dijkstra requires non-negative edge weights");
+    }
+    using entry_type = std::pair<int64_t, Node::integral_type>;
+    std::vector<int64_t> distances(adjacency.getSize(), unreachableDistance);
+    std::vector<entry_type> storage;
+    storage.reserve(adjacency.getSize());
+    std::priority_queue<entry_type, std::vector<entry_type>, std::greater<entry_type>> queue(std::greater<entry_type>(), std::move(storage));
+    distances[root.id] = 0;
+    queue.push(entry_type{0, root.id});
+    while (!queue.empty())
+    {
+        entry_type top = queue.top();
+        queue.pop();
+        if (top.first != distances[top.second])
+        {
+            continue;
+        }
+        adjacency.forEachEdge(top.second, [&distances, &queue, &top](Node::integral_type target, edge_weight_type weight)
+        {
+            int64_t candidate = top.first + weight;
+            if (candidate < distances[target])
+            {
+                distances[target] = candidate;
+                queue.push(entry_type{candidate, target});
+            }
+        });
+    }
+    return distances;
+}
+
+}
+
+}
@@ -0,0 +1,197 @@
+#ifndef COMPRESSEDADJACENCY_H
+#define COMPRESSEDADJACENCY_H
+
+#include <vector>
+#include <cstddef>
+#include <cstring>
+#include "adjacencylist.h"
+#include "commontypes.hpp"
+#include "graph.h"
+
+namespace Graphs
+{
+
+// Read-only adjacency with compressed rows. Each row is laid out as
+//   weight codes, bit-packed | length codes, 2 bits per target | target deltas, 1-4 bytes each
+// where targets are sorted, the first one stored zigzag-encoded relative to the row's own node and
+// the others as gaps to their predecessor. Keeping the byte lengths apart from the data (the StreamVByte
+// layout) lets a delta be decoded with one unaligned load and a mask instead of a branch per byte.
+// Weights are replaced by indices into a sorted dictionary of the distinct weights, ceil(log2(dictionary
+// size)) bits each, so uniformly weighted graphs spend no bits on weights at all.
+// The row index packs each row's byte offset with its degree, so opening a row costs the same single
+// dependent load as in a CSR; only degrees too large for the index are prefixed to the row as a varint.
+class CompressedAdjacency
+{
+public:
+    using offset_type = std::size_t;
+
+private:
+    // Byte offset in the low indexOffsetBits bits, degree (or largeDegree) above them.
+    std::vector<uint64_t> m_index;
+    std::vector<uint8_t> m_bytes;
+    std::vector<edge_weight_type> m_dictionary;
+    offset_type m_edgesCount;
+    offset_type m_targetBytes;
+    offset_type m_weightBytes;
+    unsigned m_weightBits;
+
+    static constexpr unsigned indexOffsetBits = 40;
+    static constexpr uint64_t largeDegree = (uint64_t{1} << (64 - indexOffsetBits)) - 1;
+
+    static uint32_t readVarint(uint8_t const*& cursor) noexcept;
+    uint8_t const* openRow(Node::integral_type node, uint32_t& degree) const noexcept;
+    static uint8_t const* readGroup(uint8_t lengths, uint8_t const* data, uint32_t (&deltas)[4]) noexcept;
+
+public:
+    CompressedAdjacency();
+    explicit CompressedAdjacency(AdjacencyList const& adjacency);
+    explicit CompressedAdjacency(Graph const& graph);
+    CompressedAdjacency(CompressedAdjacency const&) = default;
+    CompressedAdjacency(CompressedAdjacency&&) = default;
+    CompressedAdjacency& operator=(CompressedAdjacency const&) = default;
+    CompressedAdjacency& operator=(CompressedAdjacency&&) = default;
+    ~CompressedAdjacency() = default;
+
+    uint32_t getSize() const noexcept;
+    offset_type getEdgesCount() const noexcept;
+    uint32_t getDegree(Node::integral_type node) const noexcept;
+    unsigned getWeightBits() const noexcept;
+    std::vector<edge_weight_type> const& getDictionary() const noexcept;
+    edge_weight_type getMinWeight() const noexcept;
+
+    // Calls visit(target) for every neighbour of `node` in increasing id order, skipping the weights.
+    template <typename Visitor>
+    void forEachTarget(Node::integral_type node, Visitor&& visit) const;
+    // Calls visit(target, weight) for every neighbour of `node` in increasing id order.
+    template <typename Visitor>
+    void forEachEdge(Node::integral_type node, Visitor&& visit) const;
+
+    AdjacencyList decompress() const;
+    MemoryUsage memoryUsage() const noexcept;
+};
+
+inline uint32_t CompressedAdjacency::readVarint(uint8_t const*& cursor) noexcept
+{
+    uint32_t value = *cursor++;
+    if (value < 0x80)
+    {
+        return value;
+    }
+    value &= 0x7F;
+    for (unsigned shift = 7;; shift += 7)
+    {
+        uint32_t byte = *cursor++;
+        value |= (byte & 0x7F) << shift;
+        if (byte < 0x80)
+        {
+            return value;
+        }
+    }
+}
+
+inline uint8_t const* CompressedAdjacency::readGroup(uint8_t lengths, uint8_t const* data, uint32_t (&deltas)[4]) noexcept
+{
+    // All four positions follow from the length byte alone, so the loads below do not wait on each other.
+    // Past the end of a row the unused lengths read as one byte; the buffer is padded for those loads.
+    static constexpr uint32_t masks[4] = {0xFFU, 0xFFFFU, 0xFFFFFFU, 0xFFFFFFFFU};
+    for (unsigned index = 0; index < 4; ++index)
+    {
+        unsigned length = (lengths >> (index * 2)) & 3U;
+        uint32_t value;
+        std::memcpy(&value, data, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        value = __builtin_bswap32(value);
+#endif
+        deltas[index] = value & masks[length];
+        data += length + 1;
+    }
+    return data;
+}
+
+inline uint8_t const* CompressedAdjacency::openRow(Node::integral_type node, uint32_t& degree) const noexcept
+{
+    uint64_t entry = m_index[node];
+    uint8_t const* cursor = m_bytes.data() + (entry & ((uint64_t{1} << indexOffsetBits) - 1));
+    degree = static_cast<uint32_t>(entry >> indexOffsetBits);
+    if (degree == largeDegree)
+    {
+        degree = readVarint(cursor);
+    }
+    return cursor;
+}
+
+template <typename Visitor>
+void CompressedAdjacency::forEachTarget(Node::integral_type node, Visitor&& visit) const
+{
+    uint32_t degree;
+    uint8_t const* cursor = openRow(node, degree);
+    if (degree == 0)
+    {
+        return;
+    }
+    uint8_t const* lengths = cursor + (static_cast<std::size_t>(degree) * m_weightBits + 7) / 8;
+    uint8_t const* data = lengths + (degree + 3) / 4;
+    uint32_t deltas[4];
+    Node::integral_type target = node;
+    for (uint32_t index = 0; index < degree; index += 4)
+    {
+        data = readGroup(lengths[index / 4], data, deltas);
+        if (index == 0)
+        {
+            deltas[0] = (deltas[0] >> 1) ^ (0U - (deltas[0] & 1U));
+        }
+        for (uint32_t slot = 0; slot < 4 && index + slot < degree; ++slot)
+        {
+            target += deltas[slot];
+            visit(target);
+        }
+    }
+}
+
+template <typename Visitor>
+void CompressedAdjacency::forEachEdge(Node::integral_type node, Visitor&& visit) const
+{
+    uint32_t degree;
+    uint8_t const* cursor = openRow(node, degree);
+    if (degree == 0)
+    {
+        return;
+    }
+    uint8_t const* codes = cursor;
+    uint8_t const* lengths = codes + (static_cast<std::size_t>(degree) * m_weightBits + 7) / 8;
+    uint8_t const* data = lengths + (degree + 3) / 4;
+    uint32_t mask = (1U << m_weightBits) - 1;
+    uint32_t deltas[4];
+    Node::integral_type target = node;
+    for (uint32_t index = 0; index < degree; index += 4)
+    {
+        data = readGroup(lengths[index / 4], data, deltas);
+        if (index == 0)
+        {
+            deltas[0] = (deltas[0] >> 1) ^ (0U - (deltas[0] & 1U));
+        }
+        for (uint32_t slot = 0; slot < 4 && index + slot < degree; ++slot)
+        {
+            target += deltas[slot];
+            // Codes are at most 16 bits wide, so three bytes always cover one.
+            std::size_t bit = static_cast<std::size_t>(index + slot) * m_weightBits;
+            uint8_t const* word = codes + bit / 8;
+            uint32_t packed = static_cast<uint32_t>(word[0]) | (static_cast<uint32_t>(word[1]) << 8) | (static_cast<uint32_t>(word[2]) << 16);
+            visit(target, m_dictionary[(packed >> (bit % 8)) & mask]);
+        }
+    }
+}
+
+namespace Algorithms
+{
+
+// Hop counts from `root`; unreached nodes hold unreachableDistance.
+std::vector<int64_t> breadthFirstDistances(CompressedAdjacency const& adjacency, Node const& root) noexcept(false);
+// Dijkstra over non-negative weights; unreached nodes hold unreachableDistance.
+std::vector<int64_t> shortestDistances(CompressedAdjacency const& adjacency, Node const& root) noexcept(false);
+
+}
+
+}
+
+#endif // COMPRESSEDADJACENCY_H
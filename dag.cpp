@@ -0,0 +1,231 @@
+#include "dag.h"
+#include "adjacencylist.h"
+#include "graph.h"
+#include "labeledgraph.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <stdexcept>
+
+namespace Graphs
+{
+
+namespace Algorithms
+{
+
+static TopologicalOrder topologicalSortImpl(AdjacencyList const& adjacency) noexcept(false);
+static std::vector<std::vector<Node>> topologicalLevelsImpl(AdjacencyList const& adjacency, unsigned threads) noexcept(false);
+static std::vector<int64_t> dagPathsImpl(Graph const& graph, Node const& root, bool longest) noexcept(false);
+
+TopologicalOrder topologicalSort(Graph const& graph) noexcept(false)
+{
+    return topologicalSortImpl(AdjacencyList{graph});
+}
+
+TopologicalOrder topologicalSort(LabeledGraph const& graph) noexcept(false)
+{
+    return topologicalSort(graph.getRawGraph());
+}
+
+std::vector<std::vector<Node>> topologicalLevels(Graph const& graph, unsigned threads) noexcept(false)
+{
+    return topologicalLevelsImpl(AdjacencyList{graph}, threads);
+}
+
+std::vector<std::vector<Node>> topologicalLevels(LabeledGraph const& graph, unsigned threads) noexcept(false)
+{
+    return topologicalLevels(graph.getRawGraph(), threads);
+}
+
+std::vector<int64_t> dagShortestPaths(Graph const& graph, Node const& root) noexcept(false)
+{
+    return dagPathsImpl(graph, root, false);
+}
+
+std::vector<int64_t> dagShortestPaths(LabeledGraph const& graph, LabeledNode const& root) noexcept(false)
+{
+    return dagPathsImpl(graph.getRawGraph(), root.node, false);
+}
+
+std::vector<int64_t> dagShortestPaths(LabeledGraph const& graph, std::string const& root) noexcept(false)
+{
+    return dagPathsImpl(graph.getRawGraph(), graph.getNode(root).node, false);
+}
+
+std::vector<int64_t> dagLongestPaths(Graph const& graph, Node const& root) noexcept(false)
+{
+    return dagPathsImpl(graph, root, true);
+}
+
+std::vector<int64_t> dagLongestPaths(LabeledGraph const& graph, LabeledNode const& root) noexcept(false)
+{
+    return dagPathsImpl(graph.getRawGraph(), root.node, true);
+}
+
+std::vector<int64_t> dagLongestPaths(LabeledGraph const& graph, std::string const& root) noexcept(false)
+{
+    return dagPathsImpl(graph.getRawGraph(), graph.getNode(root).node, true);
+}
+
+// =====================================================
+//                   IMPLEMENTATION
+// =====================================================
+
+TopologicalOrder topologicalSortImpl(AdjacencyList const& adjacency) noexcept(false)
+{
+    enum : uint8_t { White, Grey, Black };
+    uint32_t size = adjacency.getSize();
+    std::vector<uint8_t> colours(size, White);
+    std::vector<Node::integral_type> parents(size, 0);
+    std::vector<std::size_t> next(size, 0);
+    std::vector<Node::integral_type> stack;
+    TopologicalOrder result;
+    result.order.reserve(size);
+
+    // Iterative DFS; nodes are emitted in post-order and reversed at the end.
+    for (Node::integral_type root = 0; root < size; ++root)
+    {
+        if (colours[root] != White)
+        {
+            continue;
+        }
+        colours[root] = Grey;
+        next[root] = adjacency.edgesBegin(root);
+        stack.push_back(root);
+        while (!stack.empty())
+        {
+            Node::integral_type node = stack.back();
+            if (next[node] == adjacency.edgesEnd(node))
+            {
+                colours[node] = Black;
+                result.order.push_back(Node{node});
+                stack.pop_back();
+                continue;
+            }
+
+            Node::integral_type target = adjacency.getTarget(next[node]++);
+            if (colours[target] == White)
+            {
+                colours[target] = Grey;
+                parents[target] = node;
+                next[target] = adjacency.edgesBegin(target);
+                stack.push_back(target);
+            }
+            else if (colours[target] == Grey)
+            {
+                for (Node::integral_type cycleNode = node; cycleNode != target; cycleNode = parents[cycleNode])
+                {
+                    result.cycle.push_back(Node{cycleNode});
+                }
+                result.cycle.push_back(Node{target});
+                std::reverse(result.cycle.begin(), result.cycle.end());
+                result.order.clear();
+                return result;
+            }
+        }
+    }
+    std::reverse(result.order.begin(), result.order.end());
+    return result;
+}
+
+std::vector<std::vector<Node>> topologicalLevelsImpl(AdjacencyList const& adjacency, unsigned threads) noexcept(false)
+{
+    uint32_t size = adjacency.getSize();
+    std::unique_ptr<std::atomic<uint32_t>[]> inDegrees(new std::atomic<uint32_t>[size]);
+    for (Node::integral_type node = 0; node < size; ++node)
+    {
+        inDegrees[node].store(0, std::memory_order_relaxed);
+    }
+    Parallel::forEach(size, threads, [&](unsigned, std::size_t node)
+    {
+        for (auto it = adjacency.targetsBegin(static_cast<Node::integral_type>(node)); it != adjacency.targetsEnd(static_cast<Node::integral_type>(node)); ++it)
+        {
+            inDegrees[*it].fetch_add(1, std::memory_order_relaxed);
+        }
+    }, 1024);
+
+    std::vector<Node> frontier;
+    for (Node::integral_type node = 0; node < size; ++node)
+    {
+        if (inDegrees[node].load(std::memory_order_relaxed) == 0)
+        {
+            frontier.push_back(Node{node});
+        }
+    }
+
+    unsigned workers = Parallel::threadsCount(threads);
+    std::vector<std::vector<Node>> discovered(workers);
+    std::vector<std::vector<Node>> levels;
+    std::size_t placed = 0;
+    while (!frontier.empty())
+    {
+        placed += frontier.size();
+        Parallel::forEach(frontier.size(), workers, [&](unsigned worker, std::size_t index)
+        {
+            Node::integral_type node = frontier[index].id;
+            for (auto it = adjacency.targetsBegin(node); it != adjacency.targetsEnd(node); ++it)
+            {
+                if (inDegrees[*it].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    discovered[worker].push_back(Node{*it});
+                }
+            }
+        }, 256);
+        levels.push_back(std::move(frontier));
+        frontier.clear();
+        for (auto&& local : discovered)
+        {
+            frontier.insert(frontier.end(), local.begin(), local.end());
+            local.clear();
+        }
+    }
+    if (placed != size)
+    {
+        throw std::invalid_argument("The graph contains a cycle");
+    }
+    return levels;
+}
+
+std::vector<int64_t> dagPathsImpl(Graph const& graph, Node const& root, bool longest) noexcept(false)
+{
+    if (!graph.contains(root))
+    {
+        throw std::invalid_argument("Root node does not exist in the graph");
+    }
+    AdjacencyList adjacency{graph};
+    TopologicalOrder topological = topologicalSortImpl(adjacency);
+    if (!topological.cycle.empty())
+    {
+        throw std::invalid_argument("The graph contains a cycle");
+    }
+
+    std::vector<int64_t> distances(graph.getSize(), unreachableDistance);
+    distances[root.id] = 0;
+    auto first = std::find(topological.order.begin(), topological.order.end(), root);
+    for (auto node = first; node != topological.order.end(); ++node)
+    {
+        int64_t distance = distances[node->id];
+        if (distance == unreachableDistance)
+        {
+            continue;
+        }
+        edge_weight_type const* weight = adjacency.weightsBegin(node->id);
+        for (auto it = adjacency.targetsBegin(node->id); it != adjacency.targetsEnd(node->id); ++it, ++weight)
+        {
+            int64_t candidate = distance + *weight;
+            if (distances[*it] == unreachableDistance || (longest ? candidate > distances[*it] : candidate < distances[*it]))
+            {
+                distances[*it] = candidate;
+            }
+        }
+    }
+    return distances;
+}
+
+}
+
+}
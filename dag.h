@@ -0,0 +1,46 @@
+#ifndef DAG_H
+#define DAG_H
+
+#include <vector>
+#include "commontypes.hpp"
+
+namespace Graphs
+{
+
+// Forward declaration of Graph class
+class Graph;
+// Forward declaration of LabeledGraph class
+class LabeledGraph;
+
+namespace Algorithms
+{
+
+// Either `order` holds every node in topological order, or the graph is cyclic and `cycle`
+// holds the nodes of one directed cycle in edge order (an undirected edge is a 2-cycle).
+struct TopologicalOrder
+{
+    std::vector<Node> order;
+    std::vector<Node> cycle;
+};
+
+TopologicalOrder topologicalSort(Graph const& graph) noexcept(false);
+TopologicalOrder topologicalSort(LabeledGraph const& graph) noexcept(false);
+
+// Kahn wavefronts: every node of level k only depends on nodes of earlier levels.
+std::vector<std::vector<Node>> topologicalLevels(Graph const& graph, unsigned threads = 0) noexcept(false);
+std::vector<std::vector<Node>> topologicalLevels(LabeledGraph const& graph, unsigned threads = 0) noexcept(false);
+
+// Single-source distances in one topological pass; unreached nodes hold unreachableDistance.
+std::vector<int64_t> dagShortestPaths(Graph const& graph, Node const& root) noexcept(false);
+std::vector<int64_t> dagShortestPaths(LabeledGraph const& graph, LabeledNode const& root) noexcept(false);
+std::vector<int64_t> dagShortestPaths(LabeledGraph const& graph, std::string const& root) noexcept(false);
+
+std::vector<int64_t> dagLongestPaths(Graph const& graph, Node const& root) noexcept(false);
+std::vector<int64_t> dagLongestPaths(LabeledGraph const& graph, LabeledNode const& root) noexcept(false);
+std::vector<int64_t> dagLongestPaths(LabeledGraph const& graph, std::string const& root) noexcept(false);
+
+}
+
+}
+
+#endif // DAG_H
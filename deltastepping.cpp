@@ -0,0 +1,216 @@
+#include "deltastepping.h"
+#include "adjacencylist.h"
+#include "graph.h"
+#include "labeledgraph.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <stdexcept>
+
+namespace Graphs
+{
+
+namespace Algorithms
+{
+
+static edge_weight_type suggestDeltaImpl(AdjacencyList const& adjacency) noexcept;
+static std::vector<int64_t> deltaSteppingImpl(Graph const& graph, Node const& root, edge_weight_type delta, unsigned threads) noexcept(false);
+
+edge_weight_type suggestDelta(Graph const& graph) noexcept(false)
+{
+    return suggestDeltaImpl(AdjacencyList{graph});
+}
+
+std::vector<int64_t> deltaStepping(Graph const& graph, Node const& root, edge_weight_type delta, unsigned threads) noexcept(false)
+{
+    return deltaSteppingImpl(graph, root, delta, threads);
+}
+
+std::vector<int64_t> deltaStepping(LabeledGraph const& graph, LabeledNode const& root, edge_weight_type delta, unsigned threads) noexcept(false)
+{
+    return deltaSteppingImpl(graph.getRawGraph(), root.node, delta, threads);
+}
+
+std::vector<int64_t> deltaStepping(LabeledGraph const& graph, std::string const& root, edge_weight_type delta, unsigned threads) noexcept(false)
+{
+    return deltaSteppingImpl(graph.getRawGraph(), graph.getNode(root).node, delta, threads);
+}
+
+// =====================================================
+//                   IMPLEMENTATION
+// =====================================================
+
+edge_weight_type suggestDeltaImpl(AdjacencyList const& adjacency) noexcept
+{
+    // Weight histogram over the whole edge_weight_type range; delta is the quantile below which a node
+    // has on average two outgoing edges, the light/heavy balance suggested by Meyer and Sanders.
+    if (adjacency.getSize() == 0 || adjacency.getEdgesCount() == 0)
+    {
+        return 1;
+    }
+    std::vector<std::size_t> histogram(static_cast<std::size_t>(std::numeric_limits<edge_weight_type>::max()) + 1, 0);
+    std::size_t counted = 0;
+    for (Node::integral_type node = 0; node < adjacency.getSize(); ++node)
+    {
+        for (auto weight = adjacency.weightsBegin(node); weight != adjacency.weightsBegin(node) + adjacency.getDegree(node); ++weight)
+        {
+            if (*weight >= 0)
+            {
+                ++histogram[static_cast<std::size_t>(*weight)];
+                ++counted;
+            }
+        }
+    }
+    double averageDegree = static_cast<double>(counted) / adjacency.getSize();
+    double lightShare = std::min(1.0, 2.0 / std::max(averageDegree, 1e-9));
+    std::size_t wanted = static_cast<std::size_t>(lightShare * counted);
+    std::size_t seen = 0;
+    for (std::size_t weight = 0; weight < histogram.size(); ++weight)
+    {
+        seen += histogram[weight];
+        if (seen >= wanted && seen != 0)
+        {
+            return static_cast<edge_weight_type>(std::max<std::size_t>(weight, 1));
+        }
+    }
+    return std::numeric_limits<edge_weight_type>::max();
+}
+
+namespace
+{
+
+void atomicMin(std::atomic<int64_t>& target, int64_t value, bool& lowered)
+{
+    int64_t current = target.load(std::memory_order_relaxed);
+    while (value < current)
+    {
+        if (target.compare_exchange_weak(current, value, std::memory_order_relaxed))
+        {
+            lowered = true;
+            return;
+        }
+    }
+}
+
+}
+
+std::vector<int64_t> deltaSteppingImpl(Graph const& graph, Node const& root, edge_weight_type delta, unsigned threads) noexcept(false)
+{
+    if (!graph.contains(root))
+    {
+        throw std::invalid_argument("Root node does not exist in the graph");
+    }
+    else if (delta < 0)
+    {
+        throw std::invalid_argument("Bucket width must not be negative");
+    }
+    AdjacencyList adjacency{graph};
+    if (adjacency.getMinWeight() < 0)
+    {
+        throw std::invalid_argument("Delta-stepping requires non-negative edge weights");
+    }
+    if (delta == 0)
+    {
+        delta = suggestDeltaImpl(adjacency);
+    }
+
+    uint32_t size = adjacency.getSize();
+    std::unique_ptr<std::atomic<int64_t>[]> distances(new std::atomic<int64_t>[size]);
+    for (Node::integral_type node = 0; node < size; ++node)
+    {
+        distances[node].store(unreachableDistance, std::memory_order_relaxed);
+    }
+    distances[root.id].store(0, std::memory_order_relaxed);
+
+    // Tentative distances never exceed the current bucket by more than the heaviest edge,
+    // so a ring of maxWeight / delta + 1 buckets is enough.
+    std::size_t ringSize = static_cast<std::size_t>(adjacency.getMaxWeight() / delta) + 2;
+    std::vector<std::vector<Node::integral_type>> buckets(ringSize);
+    buckets[0].push_back(root.id);
+    std::size_t pending = 1;
+
+    unsigned workers = Parallel::threadsCount(threads);
+    std::vector<std::vector<Node::integral_type>> requests(workers);
+    std::vector<uint64_t> lastRound(size, 0);
+    std::vector<uint64_t> settledIn(size, std::numeric_limits<uint64_t>::max());
+    std::vector<Node::integral_type> frontier;
+    std::vector<Node::integral_type> settled;
+    uint64_t round = 0;
+
+    auto relax = [&](bool light)
+    {
+        std::vector<Node::integral_type> const& sources = light ? frontier : settled;
+        Parallel::forEach(sources.size(), workers, [&](unsigned worker, std::size_t index)
+        {
+            Node::integral_type node = sources[index];
+            int64_t base = distances[node].load(std::memory_order_relaxed);
+            edge_weight_type const* weight = adjacency.weightsBegin(node);
+            for (auto it = adjacency.targetsBegin(node); it != adjacency.targetsEnd(node); ++it, ++weight)
+            {
+                if ((*weight <= delta) == light)
+                {
+                    bool lowered = false;
+                    atomicMin(distances[*it], base + *weight, lowered);
+                    if (lowered)
+                    {
+                        requests[worker].push_back(*it);
+                    }
+                }
+            }
+        }, 256);
+        for (auto&& local : requests)
+        {
+            for (auto&& node : local)
+            {
+                std::size_t bucket = static_cast<std::size_t>(distances[node].load(std::memory_order_relaxed) / delta);
+                buckets[bucket % ringSize].push_back(node);
+                ++pending;
+            }
+            local.clear();
+        }
+    };
+
+    for (std::size_t current = 0; pending != 0; ++current)
+    {
+        std::vector<Node::integral_type>& bucket = buckets[current % ringSize];
+        settled.clear();
+        while (!bucket.empty())
+        {
+            // Keep entries that still belong to this bucket, once each per round.
+            ++round;
+            frontier.clear();
+            pending -= bucket.size();
+            for (auto&& node : bucket)
+            {
+                if (static_cast<std::size_t>(distances[node].load(std::memory_order_relaxed) / delta) == current && lastRound[node] != round)
+                {
+                    lastRound[node] = round;
+                    frontier.push_back(node);
+                    if (settledIn[node] != current)
+                    {
+                        settledIn[node] = current;
+                        settled.push_back(node);
+                    }
+                }
+            }
+            bucket.clear();
+            relax(true);
+        }
+        relax(false);
+    }
+
+    std::vector<int64_t> result(size);
+    for (Node::integral_type node = 0; node < size; ++node)
+    {
+        result[node] = distances[node].load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+}
+
+}
@@ -0,0 +1,31 @@
+#ifndef DELTASTEPPING_H
+#define DELTASTEPPING_H
+
+#include <vector>
+#include "commontypes.hpp"
+
+namespace Graphs
+{
+
+// Forward declaration of Graph class
+class Graph;
+// Forward declaration of LabeledGraph class
+class LabeledGraph;
+
+namespace Algorithms
+{
+
+// Bucket width picked from the edge weight distribution so that a node has about two light edges on average.
+edge_weight_type suggestDelta(Graph const& graph) noexcept(false);
+
+// Parallel delta-stepping single-source shortest paths over non-negative weights. delta == 0 picks
+// the width with suggestDelta(); unreached nodes hold unreachableDistance.
+std::vector<int64_t> deltaStepping(Graph const& graph, Node const& root, edge_weight_type delta = 0, unsigned threads = 0) noexcept(false);
+std::vector<int64_t> deltaStepping(LabeledGraph const& graph, LabeledNode const& root, edge_weight_type delta = 0, unsigned threads = 0) noexcept(false);
+std::vector<int64_t> deltaStepping(LabeledGraph const& graph, std::string const& root, edge_weight_type delta = 0, unsigned threads = 0) noexcept(false);
+
+}
+
+}
+
+#endif // DELTASTEPPING_H
@@ -0,0 +1,56 @@
+#include "disjointsets.h"
+#include <numeric>
+#include <utility>
+
+namespace Graphs
+{
+
+DisjointSets::DisjointSets() : m_parents(), m_ranks(), m_setsCount(0) { }
+
+DisjointSets::DisjointSets(uint32_t size) : m_parents(size), m_ranks(size, 0), m_setsCount(size)
+{
+    std::iota(m_parents.begin(), m_parents.end(), 0);
+}
+
+uint32_t DisjointSets::getSize() const noexcept
+{
+    return static_cast<uint32_t>(m_parents.size());
+}
+
+uint32_t DisjointSets::getSetsCount() const noexcept
+{
+    return m_setsCount;
+}
+
+Node::integral_type DisjointSets::find(Node::integral_type node) noexcept
+{
+    while (m_parents[node] != node)
+    {
+        m_parents[node] = m_parents[m_parents[node]];
+        node = m_parents[node];
+    }
+    return node;
+}
+
+bool DisjointSets::unite(Node::integral_type first, Node::integral_type second) noexcept
+{
+    first = find(first);
+    second = find(second);
+    if (first == second)
+    {
+        return false;
+    }
+    if (m_ranks[first] < m_ranks[second])
+    {
+        std::swap(first, second);
+    }
+    m_parents[second] = first;
+    if (m_ranks[first] == m_ranks[second])
+    {
+        ++m_ranks[first];
+    }
+    --m_setsCount;
+    return true;
+}
+
+}
@@ -0,0 +1,36 @@
+#ifndef DISJOINTSETS_H
+#define DISJOINTSETS_H
+
+#include <vector>
+#include "commontypes.hpp"
+
+namespace Graphs
+{
+
+// Union-find over node ids with union by rank and path halving.
+class DisjointSets
+{
+private:
+    std::vector<Node::integral_type> m_parents;
+    std::vector<uint8_t> m_ranks;
+    uint32_t m_setsCount;
+
+public:
+    DisjointSets();
+    DisjointSets(uint32_t size);
+    DisjointSets(DisjointSets const&) = default;
+    DisjointSets(DisjointSets&&) = default;
+    DisjointSets& operator=(DisjointSets const&) = default;
+    DisjointSets& operator=(DisjointSets&&) = default;
+    ~DisjointSets() = default;
+
+    uint32_t getSize() const noexcept;
+    uint32_t getSetsCount() const noexcept;
+
+    Node::integral_type find(Node::integral_type node) noexcept;
+    bool unite(Node::integral_type first, Node::integral_type second) noexcept;
+};
+
+}
+
+#endif // DISJOINTSETS_H
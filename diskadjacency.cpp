@@ -0,0 +1,674 @@
+#include "diskadjacency.h"
+#include "adjacencylist.h"
+#include "disjointsets.h"
+#include "fileio.h"
+#include "graph.h"
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace Graphs
+{
+
+constexpr unsigned BlockCache::streamsCount;
+constexpr std::size_t DiskAdjacency::chunkEdges;
+constexpr uint64_t DiskAdjacency::headerSize;
+
+namespace
+{
+
+constexpr char formatMagic[4] = {'G', 'D', 'S', 'K'};
+constexpr uint32_t formatVersion = 1;
+constexpr std::size_t writeBufferBytes = std::size_t{1} << 20;
+
+// Fixed part of the file; the rest of DiskAdjacency::headerSize is zero padding.
+struct FileHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t size;
+    uint64_t edgesCount;
+    // Zero when the graph has uniform weights.
+    uint64_t weightsPosition;
+    uint64_t offsetsPosition;
+    edge_weight_type uniformWeight;
+    edge_weight_type minWeight;
+};
+
+static_assert(sizeof(FileHeader) <= DiskAdjacency::headerSize, "File header does not fit its reserved space");
+
+template <typename Value>
+void append(std::vector<uint8_t>& buffer, Value value)
+{
+    uint8_t const* bytes = reinterpret_cast<uint8_t const*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(Value));
+}
+
+}
+
+BlockCache::BlockCache(int fd, uint64_t fileSize, DiskAdjacencyOptions const& options)
+    : m_fd{fd}, m_fileSize{fileSize}, m_blockBytes{options.blockBytes}, m_prefetchBlocks{std::min<unsigned>(options.prefetchBlocks, IOV_MAX - 1)},
+      m_hand{0}, m_nextStream{0}, m_statistics{0, 0, 0, 0}
+{
+    if (m_blockBytes == 0)
+    {
+        throw std::invalid_argument("Cache blocks must not be empty");
+    }
+    // A prefetch window must never wrap the clock hand around onto blocks it has just filled.
+    std::size_t capacity = std::max<std::size_t>(options.cacheBytes / m_blockBytes, 2 * (std::size_t{m_prefetchBlocks} + 1));
+    m_storage.resize(capacity * m_blockBytes);
+    m_slotBlocks.assign(capacity, std::numeric_limits<uint64_t>::max());
+    m_referenced.assign(capacity, 0);
+    m_slots.reserve(capacity);
+    std::fill(std::begin(m_streams), std::end(m_streams), std::numeric_limits<uint64_t>::max());
+}
+
+std::size_t BlockCache::takeSlot()
+{
+    while (m_referenced[m_hand] != 0)
+    {
+        m_referenced[m_hand] = 0;
+        m_hand = (m_hand + 1) % m_slotBlocks.size();
+    }
+    std::size_t slot = m_hand;
+    m_hand = (m_hand + 1) % m_slotBlocks.size();
+    if (m_slotBlocks[slot] != std::numeric_limits<uint64_t>::max())
+    {
+        m_slots.erase(m_slotBlocks[slot]);
+    }
+    return slot;
+}
+
+void BlockCache::load(uint64_t first, uint64_t count)
+{
+    std::vector<iovec> vectors;
+    vectors.reserve(count);
+    uint64_t position = first * m_blockBytes;
+    uint64_t bytes = std::min<uint64_t>(count * m_blockBytes, m_fileSize - position);
+    for (uint64_t block = first; block < first + count; ++block)
+    {
+        std::size_t slot = takeSlot();
+        m_slotBlocks[slot] = block;
+        m_referenced[slot] = 1;
+        m_slots[block] = slot;
+        std::size_t length = static_cast<std::size_t>(std::min<uint64_t>(m_blockBytes, m_fileSize - block * m_blockBytes));
+        vectors.push_back(iovec{m_storage.data() + slot * m_blockBytes, length});
+    }
+
+    ssize_t got;
+    do
+    {
+        got = ::preadv(m_fd, vectors.data(), static_cast<int>(vectors.size()), static_cast<off_t>(position));
+    } while (got < 0 && errno == EINTR);
+    if (got < 0)
+    {
+        for (uint64_t block = first; block < first + count; ++block)
+        {
+            m_slotBlocks[m_slots[block]] = std::numeric_limits<uint64_t>::max();
+            m_slots.erase(block);
+        }
+        throw FileIo::error("Could not read", "the adjacency file");
+    }
+    // Finish a short vectored read block by block.
+    uint64_t done = static_cast<uint64_t>(got);
+    for (iovec const& vector : vectors)
+    {
+        if (done < vector.iov_len)
+        {
+            FileIo::readAllAt(m_fd, static_cast<uint8_t*>(vector.iov_base) + done, vector.iov_len - done, position + done, "the adjacency file");
+            done = 0;
+        }
+        else
+        {
+            done -= vector.iov_len;
+        }
+        position += vector.iov_len;
+    }
+    m_statistics.bytesRead += bytes;
+}
+
+bool BlockCache::isSequential(uint64_t block) noexcept
+{
+    for (uint64_t& stream : m_streams)
+    {
+        if (stream == block || stream + 1 == block)
+        {
+            bool sequential = stream + 1 == block;
+            stream = block;
+            return sequential;
+        }
+    }
+    m_streams[m_nextStream] = block;
+    m_nextStream = (m_nextStream + 1) % streamsCount;
+    return false;
+}
+
+uint8_t const* BlockCache::getBlock(uint64_t block) noexcept(false)
+{
+    uint64_t blocksCount = (m_fileSize + m_blockBytes - 1) / m_blockBytes;
+    if (block >= blocksCount)
+    {
+        throw std::out_of_range("Block lies past the end of the adjacency file");
+    }
+    bool sequential = isSequential(block);
+    auto found = m_slots.find(block);
+    if (found != m_slots.end())
+    {
+        ++m_statistics.hits;
+        m_referenced[found->second] = 1;
+        return m_storage.data() + found->second * m_blockBytes;
+    }
+
+    ++m_statistics.misses;
+    uint64_t count = 1;
+    if (sequential)
+    {
+        while (count <= m_prefetchBlocks && block + count < blocksCount && m_slots.count(block + count) == 0)
+        {
+            ++count;
+        }
+        m_statistics.prefetched += count - 1;
+        uint64_t ahead = block + count;
+        if (ahead < blocksCount)
+        {
+            ::posix_fadvise(m_fd, static_cast<off_t>(ahead * m_blockBytes),
+                            static_cast<off_t>(std::min<uint64_t>(m_prefetchBlocks, blocksCount - ahead) * m_blockBytes), POSIX_FADV_WILLNEED);
+        }
+    }
+    load(block, count);
+    return m_storage.data() + m_slots[block] * m_blockBytes;
+}
+
+void BlockCache::read(uint64_t offset, std::size_t size, void* out) noexcept(false)
+{
+    uint8_t* destination = static_cast<uint8_t*>(out);
+    while (size > 0)
+    {
+        uint64_t block = offset / m_blockBytes;
+        std::size_t inside = static_cast<std::size_t>(offset % m_blockBytes);
+        std::size_t length = std::min(size, m_blockBytes - inside);
+        std::memcpy(destination, getBlock(block) + inside, length);
+        destination += length;
+        offset += length;
+        size -= length;
+    }
+}
+
+std::size_t BlockCache::getCapacity() const noexcept
+{
+    return m_storage.size();
+}
+
+BlockCacheStatistics const& BlockCache::getStatistics() const noexcept
+{
+    return m_statistics;
+}
+
+DiskAdjacency::DiskAdjacency(std::string const& path, DiskAdjacencyOptions const& options) noexcept(false)
+    : m_path{path}, m_fd{::open(path.c_str(), O_RDONLY | O_CLOEXEC)}
+{
+    if (m_fd < 0)
+    {
+        throw FileIo::error("Could not open", path);
+    }
+    try
+    {
+        struct stat status;
+        if (::fstat(m_fd, &status) != 0)
+        {
+            throw FileIo::error("Could not stat", path);
+        }
+        uint64_t fileSize = static_cast<uint64_t>(status.st_size);
+        FileHeader header;
+        if (fileSize < headerSize)
+        {
+            throw std::runtime_error("Not an adjacency file: " + path);
+        }
+        FileIo::readAllAt(m_fd, &header, sizeof(header), 0, path);
+        if (std::memcmp(header.magic, formatMagic, sizeof(formatMagic)) != 0)
+        {
+            throw std::runtime_error("Not an adjacency file: " + path);
+        }
+        else if (header.version != formatVersion)
+        {
+            throw std::runtime_error("Unsupported adjacency file version in " + path);
+        }
+        else if (header.byteOrder != FileIo::byteOrderMark)
+        {
+            throw std::runtime_error("The adjacency file " + path + " was written with a different byte order");
+        }
+        else if (header.offsetsPosition + (uint64_t{header.size} + 1) * sizeof(offset_type) != fileSize)
+        {
+            throw std::runtime_error("The adjacency file " + path + " is truncated");
+        }
+        m_size = header.size;
+        m_edgesCount = header.edgesCount;
+        m_weightsPosition = header.weightsPosition;
+        m_offsetsPosition = header.offsetsPosition;
+        m_uniformWeight = header.uniformWeight;
+        m_minWeight = header.minWeight;
+        m_cache.reset(new BlockCache{m_fd, fileSize, options});
+        // Edges are streamed from start to end far more often than they are revisited.
+        ::posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+    catch (...)
+    {
+        ::close(m_fd);
+        throw;
+    }
+}
+
+DiskAdjacency::~DiskAdjacency()
+{
+    ::close(m_fd);
+}
+
+void DiskAdjacency::write(std::string const& path, AdjacencyList const& adjacency) noexcept(false)
+{
+    DiskAdjacencyWriter writer{path, adjacency.getSize()};
+    for (Node::integral_type node = 0; node < adjacency.getSize(); ++node)
+    {
+        edge_weight_type const* weight = adjacency.weightsBegin(node);
+        for (auto target = adjacency.targetsBegin(node); target != adjacency.targetsEnd(node); ++target, ++weight)
+        {
+            writer.addEdge(node, *target, *weight);
+        }
+    }
+    writer.finish();
+}
+
+void DiskAdjacency::write(std::string const& path, Graph const& graph) noexcept(false)
+{
+    write(path, AdjacencyList{graph});
+}
+
+uint32_t DiskAdjacency::getSize() const noexcept
+{
+    return m_size;
+}
+
+DiskAdjacency::offset_type DiskAdjacency::getEdgesCount() const noexcept
+{
+    return m_edgesCount;
+}
+
+edge_weight_type DiskAdjacency::getMinWeight() const noexcept
+{
+    return m_minWeight;
+}
+
+bool DiskAdjacency::hasUniformWeights() const noexcept
+{
+    return m_weightsPosition == 0;
+}
+
+void DiskAdjacency::readOffsets(Node::integral_type first, uint32_t count, offset_type* out) const noexcept(false)
+{
+    if (first >= m_size || count > m_size - first)
+    {
+        throw std::out_of_range("Node does not exist in the graph");
+    }
+    m_cache->read(m_offsetsPosition + uint64_t{first} * sizeof(offset_type), (std::size_t{count} + 1) * sizeof(offset_type), out);
+}
+
+uint32_t DiskAdjacency::getDegree(Node::integral_type node) const noexcept(false)
+{
+    offset_type offsets[2];
+    readOffsets(node, 1, offsets);
+    return static_cast<uint32_t>(offsets[1] - offsets[0]);
+}
+
+void DiskAdjacency::readEdges(offset_type first, std::size_t count, Node::integral_type* targets, edge_weight_type* weights) const
+{
+    m_cache->read(headerSize + first * sizeof(Node::integral_type), count * sizeof(Node::integral_type), targets);
+    if (m_weightsPosition != 0)
+    {
+        m_cache->read(m_weightsPosition + first * sizeof(edge_weight_type), count * sizeof(edge_weight_type), weights);
+    }
+    else
+    {
+        std::fill(weights, weights + count, m_uniformWeight);
+    }
+}
+
+BlockCacheStatistics DiskAdjacency::getCacheStatistics() const noexcept
+{
+    return m_cache->getStatistics();
+}
+
+MemoryUsage DiskAdjacency::memoryUsage() const noexcept
+{
+    // Cached blocks mix targets, weights and offsets; they are all reported as adjacency.
+    return MemoryUsage{m_cache->getCapacity(), 0, 0, sizeof(DiskAdjacency) + sizeof(BlockCache) + m_path.capacity()};
+}
+
+DiskAdjacencyWriter::DiskAdjacencyWriter(std::string const& path, uint32_t size) noexcept(false)
+    : m_path{path}, m_size{size}, m_nextNode{0}, m_edgesCount{0}, m_firstWeight{1},
+      m_minWeight{std::numeric_limits<edge_weight_type>::max()}, m_uniform{true}, m_finished{false},
+      m_targetsFd{-1}, m_weightsFd{-1}, m_offsetsFd{-1}
+{
+    std::string const paths[] = {m_path + ".tmp", m_path + ".weights.tmp", m_path + ".offsets.tmp"};
+    int* const descriptors[] = {&m_targetsFd, &m_weightsFd, &m_offsetsFd};
+    for (int file = 0; file < 3; ++file)
+    {
+        *descriptors[file] = ::open(paths[file].c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (*descriptors[file] < 0)
+        {
+            std::runtime_error error = FileIo::error("Could not create", paths[file]);
+            removeTemporaries();
+            throw error;
+        }
+    }
+    m_targetsBuffer.assign(DiskAdjacency::headerSize, 0);
+    m_targetsBuffer.reserve(writeBufferBytes);
+    m_weightsBuffer.reserve(writeBufferBytes);
+    m_offsetsBuffer.reserve(writeBufferBytes);
+}
+
+DiskAdjacencyWriter::~DiskAdjacencyWriter()
+{
+    if (!m_finished)
+    {
+        removeTemporaries();
+    }
+}
+
+void DiskAdjacencyWriter::removeTemporaries() noexcept
+{
+    std::string const paths[] = {m_path + ".tmp", m_path + ".weights.tmp", m_path + ".offsets.tmp"};
+    int* const descriptors[] = {&m_targetsFd, &m_weightsFd, &m_offsetsFd};
+    for (int file = 0; file < 3; ++file)
+    {
+        if (*descriptors[file] >= 0)
+        {
+            ::close(*descriptors[file]);
+            *descriptors[file] = -1;
+            ::unlink(paths[file].c_str());
+        }
+    }
+}
+
+void DiskAdjacencyWriter::flush(int fd, std::vector<uint8_t>& buffer, std::string const& path)
+{
+    FileIo::writeAll(fd, buffer.data(), buffer.size(), path);
+    buffer.clear();
+}
+
+// Rows up to and including `last` start at the current edge count.
+void DiskAdjacencyWriter::writeOffsets(Node::integral_type last)
+{
+    for (; m_nextNode <= last; ++m_nextNode)
+    {
+        append(m_offsetsBuffer, m_edgesCount);
+        if (m_offsetsBuffer.size() >= writeBufferBytes)
+        {
+            flush(m_offsetsFd, m_offsetsBuffer, m_path + ".offsets.tmp");
+        }
+    }
+}
+
+void DiskAdjacencyWriter::addEdge(Node::integral_type source, Node::integral_type target, edge_weight_type weight) noexcept(false)
+{
+    if (m_finished)
+    {
+        throw std::logic_error("The adjacency file is already finished");
+    }
+    else if (source >= m_size || target >= m_size)
+    {
+        throw std::invalid_argument("Node does not exist in the graph");
+    }
+    else if (source + 1 < m_nextNode)
+    {
+        throw std::invalid_argument("Edges must be added in non-decreasing source order");
+    }
+    writeOffsets(source);
+
+    if (m_edgesCount == 0)
+    {
+        m_firstWeight = weight;
+    }
+    m_uniform = m_uniform && weight == m_firstWeight;
+    m_minWeight = std::min(m_minWeight, weight);
+    append(m_targetsBuffer, target);
+    append(m_weightsBuffer, weight);
+    ++m_edgesCount;
+    if (m_targetsBuffer.size() >= writeBufferBytes)
+    {
+        flush(m_targetsFd, m_targetsBuffer, m_path + ".tmp");
+    }
+    if (m_weightsBuffer.size() >= writeBufferBytes)
+    {
+        flush(m_weightsFd, m_weightsBuffer, m_path + ".weights.tmp");
+    }
+}
+
+void DiskAdjacencyWriter::finish() noexcept(false)
+{
+    if (m_finished)
+    {
+        throw std::logic_error("The adjacency file is already finished");
+    }
+    std::string temporary = m_path + ".tmp";
+    writeOffsets(m_size);
+    flush(m_targetsFd, m_targetsBuffer, temporary);
+    flush(m_offsetsFd, m_offsetsBuffer, m_path + ".offsets.tmp");
+    flush(m_weightsFd, m_weightsBuffer, m_path + ".weights.tmp");
+
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, formatMagic, sizeof(formatMagic));
+    header.version = formatVersion;
+    header.byteOrder = FileIo::byteOrderMark;
+    header.size = m_size;
+    header.edgesCount = m_edgesCount;
+    header.weightsPosition = m_uniform ? 0 : DiskAdjacency::headerSize + m_edgesCount * sizeof(Node::integral_type);
+    header.offsetsPosition = DiskAdjacency::headerSize + m_edgesCount * (sizeof(Node::integral_type) + (m_uniform ? 0 : sizeof(edge_weight_type)));
+    header.uniformWeight = m_firstWeight;
+    header.minWeight = m_edgesCount == 0 ? m_firstWeight : m_minWeight;
+
+    // Append the weights, unless they are all equal, and the offsets behind the targets.
+    std::vector<int> sources;
+    if (!m_uniform)
+    {
+        sources.push_back(m_weightsFd);
+    }
+    sources.push_back(m_offsetsFd);
+    for (int source : sources)
+    {
+        std::string const sourcePath = source == m_offsetsFd ? m_path + ".offsets.tmp" : m_path + ".weights.tmp";
+        uint64_t position = 0;
+        while (true)
+        {
+            m_targetsBuffer.resize(writeBufferBytes);
+            m_targetsBuffer.resize(FileIo::readAt(source, m_targetsBuffer.data(), m_targetsBuffer.size(), position, sourcePath));
+            if (m_targetsBuffer.empty())
+            {
+                break;
+            }
+            position += m_targetsBuffer.size();
+            flush(m_targetsFd, m_targetsBuffer, temporary);
+        }
+    }
+
+    std::vector<uint8_t> headerBytes(DiskAdjacency::headerSize, 0);
+    std::memcpy(headerBytes.data(), &header, sizeof(header));
+    if (::pwrite(m_targetsFd, headerBytes.data(), headerBytes.size(), 0) != static_cast<ssize_t>(headerBytes.size())
+            || ::fsync(m_targetsFd) != 0)
+    {
+        throw FileIo::error("Could not write", temporary);
+    }
+    if (::rename(temporary.c_str(), m_path.c_str()) != 0)
+    {
+        throw FileIo::error("Could not rename", temporary);
+    }
+    ::close(m_targetsFd);
+    m_targetsFd = -1;
+    removeTemporaries();
+    m_finished = true;
+}
+
+namespace Algorithms
+{
+
+namespace
+{
+
+// Below this share of the nodes a level reads its frontier's rows one by one; above it, scanning the whole
+// file sequentially moves fewer bytes than seeking from row to row.
+constexpr uint32_t scanDivisor = 16;
+
+}
+
+std::vector<int64_t> breadthFirstDistances(DiskAdjacency const& adjacency, Node const& root) noexcept(false)
+{
+    if (root.id >= adjacency.getSize())
+    {
+        throw std::invalid_argument("Root node does not exist in the graph");
+    }
+    std::vector<int64_t> distances(adjacency.getSize(), unreachableDistance);
+    std::vector<Node::integral_type> frontier{root.id};
+    std::vector<Node::integral_type> next;
+    distances[root.id] = 0;
+    for (int64_t level = 1; !frontier.empty(); ++level)
+    {
+        auto discover = [&distances, &next, level](Node::integral_type target, edge_weight_type)
+        {
+            if (distances[target] == unreachableDistance)
+            {
+                distances[target] = level;
+                next.push_back(target);
+            }
+        };
+        if (frontier.size() > adjacency.getSize() / scanDivisor)
+        {
+            adjacency.forEachEdge([&distances, &discover, level](Node::integral_type source, Node::integral_type target, edge_weight_type weight)
+            {
+                if (distances[source] == level - 1)
+                {
+                    discover(target, weight);
+                }
+            });
+        }
+        else
+        {
+            std::sort(frontier.begin(), frontier.end());
+            for (Node::integral_type node : frontier)
+            {
+                adjacency.forEachEdge(node, discover);
+            }
+        }
+        frontier.swap(next);
+        next.clear();
+    }
+    return distances;
+}
+
+std::vector<uint32_t> connectedComponents(DiskAdjacency const& adjacency) noexcept(false)
+{
+    DisjointSets sets{adjacency.getSize()};
+    adjacency.forEachEdge([&sets](Node::integral_type source, Node::integral_type target, edge_weight_type)
+    {
+        sets.unite(source, target);
+    });
+
+    constexpr uint32_t unnumbered = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> numbers(adjacency.getSize(), unnumbered);
+    std::vector<uint32_t> components(adjacency.getSize());
+    uint32_t count = 0;
+    for (Node::integral_type node = 0; node < adjacency.getSize(); ++node)
+    {
+        Node::integral_type representative = sets.find(node);
+        if (numbers[representative] == unnumbered)
+        {
+            numbers[representative] = count++;
+        }
+        components[node] = numbers[representative];
+    }
+    return components;
+}
+
+std::vector<int64_t> shortestDistances(DiskAdjacency const& adjacency, Node const& root) noexcept(false)
+{
+    if (root.id >= adjacency.getSize())
+    {
+        throw std::invalid_argument("Root node does not exist in the graph");
+    }
+    uint32_t size = adjacency.getSize();
+    std::vector<int64_t> distances(size, unreachableDistance);
+    // Nodes to relax in this round and in the next one; an improvement ahead of the sweep is handled in the
+    // same round.
+    std::vector<uint8_t> active(size, 0);
+    std::vector<uint8_t> pending(size, 0);
+    distances[root.id] = 0;
+    active[root.id] = 1;
+    uint32_t activeCount = 1;
+    for (uint32_t round = 0; activeCount > 0; ++round)
+    {
+        // Without negative cycles every shortest path settles within size - 1 rounds.
+        if (round >= size)
+        {
+            throw std::runtime_error("Graph contains a negative cycle reachable from the root");
+        }
+        uint32_t nextCount = 0;
+        Node::integral_type current = 0;
+        auto relax = [&distances, &active, &pending, &nextCount, &current](Node::integral_type source, Node::integral_type target,
+                                                                         edge_weight_type weight)
+        {
+            int64_t candidate = distances[source] + weight;
+            if (candidate < distances[target])
+            {
+                distances[target] = candidate;
+                std::vector<uint8_t>& flags = target > current ? active : pending;
+                if (flags[target] == 0)
+                {
+                    flags[target] = 1;
+                    nextCount += &flags == &pending ? 1 : 0;
+                }
+            }
+        };
+        if (activeCount > size / scanDivisor)
+        {
+            adjacency.forEachEdge([&active, &relax, &current](Node::integral_type source, Node::integral_type target, edge_weight_type weight)
+            {
+                if (active[source] != 0)
+                {
+                    current = source;
+                    relax(source, target, weight);
+                }
+            });
+        }
+        else
+        {
+            for (Node::integral_type node = 0; node < size; ++node)
+            {
+                if (active[node] != 0)
+                {
+                    current = node;
+                    adjacency.forEachEdge(node, [&relax, node](Node::integral_type target, edge_weight_type weight)
+                    {
+                        relax(node, target, weight);
+                    });
+                }
+            }
+        }
+
+        // Nodes activated ahead of the sweep were relaxed in this round already.
+        std::fill(active.begin(), active.end(), 0);
+        active.swap(pending);
+        activeCount = nextCount;
+    }
+    return distances;
+}
+
+}
+
+}
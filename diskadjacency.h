@@ -0,0 +1,247 @@
+#ifndef DISKADJACENCY_H
+#define DISKADJACENCY_H
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <cstddef>
+#include "commontypes.hpp"
+#include "graph.h"
+
+namespace Graphs
+{
+
+// Forward declaration of AdjacencyList class
+class AdjacencyList;
+
+struct DiskAdjacencyOptions
+{
+    // Upper bound for the block cache; node state kept by the algorithms comes on top of it.
+    std::size_t cacheBytes = std::size_t{256} << 20;
+    std::size_t blockBytes = std::size_t{256} << 10;
+    // Blocks read ahead, in the same request, once a sequential run is detected.
+    unsigned prefetchBlocks = 8;
+};
+
+struct BlockCacheStatistics
+{
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t prefetched;
+    uint64_t bytesRead;
+};
+
+// Fixed-size block cache over a read-only file with CLOCK eviction. A few independent access streams are
+// tracked; when a stream asks for the block following its previous one, the miss is served with a single
+// vectored read of the following prefetchBlocks blocks as well, and the kernel is advised to fetch the
+// window after that in the background.
+class BlockCache
+{
+private:
+    static constexpr unsigned streamsCount = 4;
+
+    int m_fd;
+    uint64_t m_fileSize;
+    std::size_t m_blockBytes;
+    unsigned m_prefetchBlocks;
+    std::vector<uint8_t> m_storage;
+    std::vector<uint64_t> m_slotBlocks;
+    std::vector<uint8_t> m_referenced;
+    std::size_t m_hand;
+    std::unordered_map<uint64_t, std::size_t> m_slots;
+    uint64_t m_streams[streamsCount];
+    unsigned m_nextStream;
+    BlockCacheStatistics m_statistics;
+
+    std::size_t takeSlot();
+    void load(uint64_t first, uint64_t count);
+    bool isSequential(uint64_t block) noexcept;
+
+public:
+    BlockCache(int fd, uint64_t fileSize, DiskAdjacencyOptions const& options);
+    BlockCache(BlockCache const&) = delete;
+    BlockCache(BlockCache&&) = delete;
+    BlockCache& operator=(BlockCache const&) = delete;
+    BlockCache& operator=(BlockCache&&) = delete;
+    ~BlockCache() = default;
+
+    // The returned block stays valid until the next call.
+    uint8_t const* getBlock(uint64_t block) noexcept(false);
+    void read(uint64_t offset, std::size_t size, void* out) noexcept(false);
+
+    std::size_t getCapacity() const noexcept;
+    BlockCacheStatistics const& getStatistics() const noexcept;
+};
+
+// Read-only adjacency kept in a file and read through a bounded BlockCache, for graphs whose edges do not
+// fit in memory. The file holds a fixed header, then the targets of all rows, their weights (left out when
+// every edge has the same weight) and the row offsets, so only the cache and what the caller keeps per
+// node reside in RAM. Files are written by DiskAdjacencyWriter in the byte order of the writing host.
+// Reads go through a mutable cache: a DiskAdjacency must not be shared between threads, and visitors must
+// not call back into the adjacency they are visiting.
+class DiskAdjacency
+{
+public:
+    using offset_type = uint64_t;
+
+private:
+    std::string m_path;
+    int m_fd;
+    uint32_t m_size;
+    offset_type m_edgesCount;
+    uint64_t m_weightsPosition;
+    uint64_t m_offsetsPosition;
+    edge_weight_type m_uniformWeight;
+    edge_weight_type m_minWeight;
+    std::unique_ptr<BlockCache> m_cache;
+
+    static constexpr std::size_t chunkEdges = 1024;
+
+    // Copies the targets and weights of edges [first, first + count) into the given arrays.
+    void readEdges(offset_type first, std::size_t count, Node::integral_type* targets, edge_weight_type* weights) const;
+
+public:
+    static constexpr uint64_t headerSize = 64;
+
+    explicit DiskAdjacency(std::string const& path, DiskAdjacencyOptions const& options = DiskAdjacencyOptions{}) noexcept(false);
+    DiskAdjacency(DiskAdjacency const&) = delete;
+    DiskAdjacency(DiskAdjacency&&) = delete;
+    DiskAdjacency& operator=(DiskAdjacency const&) = delete;
+    DiskAdjacency& operator=(DiskAdjacency&&) = delete;
+    ~DiskAdjacency();
+
+    static void write(std::string const& path, AdjacencyList const& adjacency) noexcept(false);
+    static void write(std::string const& path, Graph const& graph) noexcept(false);
+
+    uint32_t getSize() const noexcept;
+    offset_type getEdgesCount() const noexcept;
+    edge_weight_type getMinWeight() const noexcept;
+    bool hasUniformWeights() const noexcept;
+
+    // Offsets of nodes [first, first + count] into out, count + 1 values.
+    void readOffsets(Node::integral_type first, uint32_t count, offset_type* out) const noexcept(false);
+    uint32_t getDegree(Node::integral_type node) const noexcept(false);
+
+    // Calls visit(target, weight) for every edge leaving `node`.
+    template <typename Visitor>
+    void forEachEdge(Node::integral_type node, Visitor&& visit) const;
+    // Calls visit(source, target, weight) for every edge, streaming the whole file once in node order.
+    template <typename Visitor>
+    void forEachEdge(Visitor&& visit) const;
+
+    BlockCacheStatistics getCacheStatistics() const noexcept;
+    // Resident memory only: the cache buffers and bookkeeping, not the file.
+    MemoryUsage memoryUsage() const noexcept;
+};
+
+// Builds a DiskAdjacency file from edges streamed in non-decreasing source order, keeping only write
+// buffers in memory. Targets go straight to the destination file, weights and offsets to temporary files
+// appended by finish(); the result is renamed into place, so `path` never holds a partial graph.
+class DiskAdjacencyWriter
+{
+private:
+    std::string m_path;
+    uint32_t m_size;
+    Node::integral_type m_nextNode;
+    uint64_t m_edgesCount;
+    edge_weight_type m_firstWeight;
+    edge_weight_type m_minWeight;
+    bool m_uniform;
+    bool m_finished;
+    int m_targetsFd;
+    int m_weightsFd;
+    int m_offsetsFd;
+    std::vector<uint8_t> m_targetsBuffer;
+    std::vector<uint8_t> m_weightsBuffer;
+    std::vector<uint8_t> m_offsetsBuffer;
+
+    void writeOffsets(Node::integral_type last);
+    void flush(int fd, std::vector<uint8_t>& buffer, std::string const& path);
+    void removeTemporaries() noexcept;
+
+public:
+    DiskAdjacencyWriter(std::string const& path, uint32_t size) noexcept(false);
+    DiskAdjacencyWriter(DiskAdjacencyWriter const&) = delete;
+    DiskAdjacencyWriter(DiskAdjacencyWriter&&) = delete;
+    DiskAdjacencyWriter& operator=(DiskAdjacencyWriter const&) = delete;
+    DiskAdjacencyWriter& operator=(DiskAdjacencyWriter&&) = delete;
+    // Discards the temporaries when finish() was not reached.
+    ~DiskAdjacencyWriter();
+
+    void addEdge(Node::integral_type source, Node::integral_type target, edge_weight_type weight = 1) noexcept(false);
+    void finish() noexcept(false);
+};
+
+// ===== IMPLEMENTATION =====
+
+template <typename Visitor>
+void DiskAdjacency::forEachEdge(Node::integral_type node, Visitor&& visit) const
+{
+    offset_type offsets[2];
+    readOffsets(node, 1, offsets);
+    Node::integral_type targets[chunkEdges];
+    edge_weight_type weights[chunkEdges];
+    for (offset_type edge = offsets[0]; edge < offsets[1]; edge += chunkEdges)
+    {
+        std::size_t count = static_cast<std::size_t>(std::min<offset_type>(chunkEdges, offsets[1] - edge));
+        readEdges(edge, count, targets, weights);
+        for (std::size_t index = 0; index < count; ++index)
+        {
+            visit(targets[index], weights[index]);
+        }
+    }
+}
+
+template <typename Visitor>
+void DiskAdjacency::forEachEdge(Visitor&& visit) const
+{
+    constexpr uint32_t chunkNodes = 1024;
+    offset_type offsets[chunkNodes + 1];
+    Node::integral_type targets[chunkEdges];
+    edge_weight_type weights[chunkEdges];
+    Node::integral_type source = 0;
+    Node::integral_type next = 0;
+    offset_type rowEnd = 0;
+    // Offsets and edges are consumed as two sequential streams; edges are read in chunks that may span rows.
+    for (offset_type edge = 0; edge < m_edgesCount; edge += chunkEdges)
+    {
+        std::size_t count = static_cast<std::size_t>(std::min<offset_type>(chunkEdges, m_edgesCount - edge));
+        readEdges(edge, count, targets, weights);
+        for (std::size_t index = 0; index < count; ++index)
+        {
+            while (edge + index >= rowEnd)
+            {
+                if (next % chunkNodes == 0)
+                {
+                    readOffsets(next, std::min(chunkNodes, m_size - next), offsets);
+                }
+                source = next++;
+                rowEnd = offsets[source % chunkNodes + 1];
+            }
+            visit(source, targets[index], weights[index]);
+        }
+    }
+}
+
+namespace Algorithms
+{
+
+// Level-synchronous BFS keeping only distances and the frontier in memory. Each level reads the rows of
+// the frontier in increasing id order, or streams the whole file when the frontier is a large share of
+// the graph; unreached nodes hold unreachableDistance.
+std::vector<int64_t> breadthFirstDistances(DiskAdjacency const& adjacency, Node const& root) noexcept(false);
+// Weakly connected components from one sequential pass over the edges into a union-find. Components are
+// numbered from 0 in order of their smallest node.
+std::vector<uint32_t> connectedComponents(DiskAdjacency const& adjacency) noexcept(false);
+// Bellman-Ford with an active set: every round relaxes the edges of nodes improved in the previous one, in
+// id order so that improvements propagate within the round. Negative weights are allowed; a negative cycle
+// reachable from `root` throws std::runtime_error.
+std::vector<int64_t> shortestDistances(DiskAdjacency const& adjacency, Node const& root) noexcept(false);
+
+}
+
+}
+
+#endif // DISKADJACENCY_H
@@ -0,0 +1,145 @@
+#include "fileio.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace Graphs
+{
+
+namespace FileIo
+{
+
+std::runtime_error error(std::string const& what, std::string const& path)
+{
+    return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+void writeAll(int fd, void const* data, std::size_t size, std::string const& path) noexcept(false)
+{
+    uint8_t const* bytes = static_cast<uint8_t const*>(data);
+    while (size > 0)
+    {
+        ssize_t written = ::write(fd, bytes, size);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throw error("Could not write", path);
+        }
+        bytes += written;
+        size -= static_cast<std::size_t>(written);
+    }
+}
+
+void readAll(int fd, void* data, std::size_t size, std::string const& path) noexcept(false)
+{
+    uint8_t* bytes = static_cast<uint8_t*>(data);
+    while (size > 0)
+    {
+        ssize_t got = ::read(fd, bytes, size);
+        if (got < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throw error("Could not read", path);
+        }
+        else if (got == 0)
+        {
+            throw std::runtime_error("Unexpected end of " + path);
+        }
+        bytes += got;
+        size -= static_cast<std::size_t>(got);
+    }
+}
+
+void readAllAt(int fd, void* data, std::size_t size, uint64_t position, std::string const& path) noexcept(false)
+{
+    if (readAt(fd, data, size, position, path) != size)
+    {
+        throw std::runtime_error("Unexpected end of " + path);
+    }
+}
+
+std::size_t readAt(int fd, void* data, std::size_t size, uint64_t position, std::string const& path) noexcept(false)
+{
+    uint8_t* bytes = static_cast<uint8_t*>(data);
+    std::size_t done = 0;
+    while (done < size)
+    {
+        ssize_t got = ::pread(fd, bytes + done, size - done, static_cast<off_t>(position + done));
+        if (got < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throw error("Could not read", path);
+        }
+        else if (got == 0)
+        {
+            break;
+        }
+        done += static_cast<std::size_t>(got);
+    }
+    return done;
+}
+
+bool readFile(std::string const& path, std::vector<uint8_t>& contents) noexcept(false)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        if (errno == ENOENT)
+        {
+            return false;
+        }
+        throw error("Could not open", path);
+    }
+    contents.clear();
+    uint8_t buffer[1 << 16];
+    while (true)
+    {
+        ssize_t got = ::read(fd, buffer, sizeof(buffer));
+        if (got < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            std::runtime_error failure = error("Could not read", path);
+            ::close(fd);
+            throw failure;
+        }
+        else if (got == 0)
+        {
+            break;
+        }
+        contents.insert(contents.end(), buffer, buffer + got);
+    }
+    ::close(fd);
+    return true;
+}
+
+void syncFile(int fd, std::string const& path) noexcept(false)
+{
+#ifdef __APPLE__
+    int result = ::fsync(fd);
+#else
+    int result = ::fdatasync(fd);
+#endif
+    if (result != 0)
+    {
+        throw error("Could not sync", path);
+    }
+}
+
+}
+
+}
@@ -0,0 +1,39 @@
+#ifndef FILEIO_H
+#define FILEIO_H
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Graphs
+{
+
+// POSIX file helpers shared by the binary formats and the journal. Every call retries on EINTR and
+// finishes short transfers; failures throw std::runtime_error naming the file and the system error.
+namespace FileIo
+{
+
+// Stored in file headers so that a file is never read back on a machine of the other byte order.
+constexpr uint32_t byteOrderMark = 0x01020304;
+
+// "<what> <path>: <strerror(errno)>"
+std::runtime_error error(std::string const& what, std::string const& path);
+
+void writeAll(int fd, void const* data, std::size_t size, std::string const& path) noexcept(false);
+// Exactly `size` bytes from the current offset; the end of the file coming first is an error.
+void readAll(int fd, void* data, std::size_t size, std::string const& path) noexcept(false);
+// Exactly `size` bytes at `position`, leaving the file offset alone.
+void readAllAt(int fd, void* data, std::size_t size, uint64_t position, std::string const& path) noexcept(false);
+// Up to `size` bytes at `position`; fewer only at the end of the file.
+std::size_t readAt(int fd, void* data, std::size_t size, uint64_t position, std::string const& path) noexcept(false);
+// Returns false when the file does not exist.
+bool readFile(std::string const& path, std::vector<uint8_t>& contents) noexcept(false);
+void syncFile(int fd, std::string const& path) noexcept(false);
+
+}
+
+}
+
+#endif // FILEIO_H
@@ -0,0 +1,205 @@
+#include "generators.h"
+#include "graph.h"
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <stdexcept>
+
+namespace Graphs
+{
+
+namespace Generators
+{
+
+namespace
+{
+
+class EdgeFactory
+{
+private:
+    std::mt19937_64 m_generator;
+    std::uniform_int_distribution<int32_t> m_weights;
+    EdgeDirection m_direction;
+
+    // Checked before the distribution exists: constructing it with min > max is undefined behaviour.
+    static std::uniform_int_distribution<int32_t>::param_type weightRange(GeneratorOptions const& options)
+    {
+        if (options.minWeight > options.maxWeight)
+        {
+            throw std::invalid_argument("Minimal weight exceeds maximal weight");
+        }
+        return std::uniform_int_distribution<int32_t>::param_type(options.minWeight, options.maxWeight);
+    }
+
+public:
+    explicit EdgeFactory(GeneratorOptions const& options) : m_generator(options.seed), m_weights(weightRange(options)),
+                                                            m_direction(options.direction)
+    {
+    }
+
+    std::mt19937_64& random()
+    {
+        return m_generator;
+    }
+
+    void connect(Graph& graph, Node::integral_type src, Node::integral_type target)
+    {
+        graph.insertEdge(src, target, static_cast<edge_weight_type>(m_weights(m_generator)), m_direction);
+    }
+};
+
+}
+
+Graph erdosRenyi(uint32_t size, uint64_t edges, GeneratorOptions const& options) noexcept(false)
+{
+    uint64_t pairs = static_cast<uint64_t>(size) * (size > 0 ? size - 1 : 0);
+    if (options.direction == EdgeDirection::Undirected)
+    {
+        pairs /= 2;
+    }
+    if (edges > pairs)
+    {
+        throw std::invalid_argument("More edges requested than node pairs available");
+    }
+    EdgeFactory factory{options};
+    Graph graph{size, GraphRepresentation::Sparse};
+    std::uniform_int_distribution<uint32_t> pick(0, size > 0 ? size - 1 : 0);
+    for (uint64_t inserted = 0; inserted < edges; )
+    {
+        Node::integral_type src = pick(factory.random());
+        Node::integral_type target = pick(factory.random());
+        if (src != target && !graph.areNodesConnected(src, target))
+        {
+            factory.connect(graph, src, target);
+            ++inserted;
+        }
+    }
+    graph.optimizeRepresentation();
+    return graph;
+}
+
+Graph rmat(uint32_t scale, uint32_t edgeFactor, GeneratorOptions const& options, double a, double b, double c) noexcept(false)
+{
+    if (scale >= 32 || a < 0 || b < 0 || c < 0 || a + b + c > 1.0)
+    {
+        throw std::invalid_argument("Invalid R-MAT parameters");
+    }
+    uint32_t size = 1U << scale;
+    EdgeFactory factory{options};
+    Graph graph{size, GraphRepresentation::Sparse};
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    uint64_t draws = static_cast<uint64_t>(edgeFactor) * size;
+    for (uint64_t draw = 0; draw < draws; ++draw)
+    {
+        Node::integral_type src = 0;
+        Node::integral_type target = 0;
+        for (uint32_t bit = 0; bit < scale; ++bit)
+        {
+            double quadrant = unit(factory.random());
+            src <<= 1;
+            target <<= 1;
+            if (quadrant < a)
+            {
+            }
+            else if (quadrant < a + b)
+            {
+                target |= 1;
+            }
+            else if (quadrant < a + b + c)
+            {
+                src |= 1;
+            }
+            else
+            {
+                src |= 1;
+                target |= 1;
+            }
+        }
+        if (src != target)
+        {
+            factory.connect(graph, src, target);
+        }
+    }
+    graph.optimizeRepresentation();
+    return graph;
+}
+
+Graph grid(uint32_t rows, uint32_t columns, GeneratorOptions const& options, double shortcuts) noexcept(false)
+{
+    uint64_t size = static_cast<uint64_t>(rows) * columns;
+    if (size > std::numeric_limits<uint32_t>::max())
+    {
+        throw std::invalid_argument("Grid is too large");
+    }
+    EdgeFactory factory{options};
+    Graph graph{static_cast<uint32_t>(size), GraphRepresentation::Sparse};
+    std::bernoulli_distribution diagonal(std::min(std::max(shortcuts, 0.0), 1.0));
+    for (uint32_t row = 0; row < rows; ++row)
+    {
+        for (uint32_t column = 0; column < columns; ++column)
+        {
+            Node::integral_type node = row * columns + column;
+            if (column + 1 < columns)
+            {
+                factory.connect(graph, node, node + 1);
+            }
+            if (row + 1 < rows)
+            {
+                factory.connect(graph, node, node + columns);
+                if (column + 1 < columns && diagonal(factory.random()))
+                {
+                    factory.connect(graph, node, node + columns + 1);
+                }
+            }
+        }
+    }
+    graph.optimizeRepresentation();
+    return graph;
+}
+
+Graph powerLaw(uint32_t size, uint32_t edgesPerNode, GeneratorOptions const& options) noexcept(false)
+{
+    if (edgesPerNode == 0 || edgesPerNode >= size)
+    {
+        throw std::invalid_argument("Edges per node must be positive and smaller than the node count");
+    }
+    EdgeFactory factory{options};
+    Graph graph{size, GraphRepresentation::Sparse};
+    // Every edge endpoint is recorded once, so a uniform pick from `endpoints` is degree-proportional.
+    std::vector<Node::integral_type> endpoints;
+    endpoints.reserve(static_cast<std::size_t>(size) * edgesPerNode * 2);
+    for (Node::integral_type node = 0; node <= edgesPerNode; ++node)
+    {
+        for (Node::integral_type other = 0; other < node; ++other)
+        {
+            factory.connect(graph, node, other);
+            endpoints.push_back(node);
+            endpoints.push_back(other);
+        }
+    }
+    for (Node::integral_type node = edgesPerNode + 1; node < size; ++node)
+    {
+        uint32_t linked = 0;
+        while (linked < edgesPerNode)
+        {
+            std::uniform_int_distribution<std::size_t> pick(0, endpoints.size() - 1);
+            Node::integral_type other = endpoints[pick(factory.random())];
+            if (!graph.areNodesConnected(node, other))
+            {
+                factory.connect(graph, node, other);
+                endpoints.push_back(other);
+                ++linked;
+            }
+        }
+        endpoints.insert(endpoints.end(), edgesPerNode, node);
+    }
+    graph.optimizeRepresentation();
+    return graph;
+}
+
+}
+
+}
@@ -0,0 +1,43 @@
+#ifndef GENERATORS_H
+#define GENERATORS_H
+
+#include "commontypes.hpp"
+
+namespace Graphs
+{
+
+// Forward declaration of Graph class
+class Graph;
+
+namespace Generators
+{
+
+struct GeneratorOptions
+{
+    uint64_t seed = 1;
+    EdgeDirection direction = EdgeDirection::Undirected;
+    edge_weight_type minWeight = 1;
+    edge_weight_type maxWeight = 1;
+};
+
+// Graphs are built in the Sparse representation, so memory follows the edge count, and are returned
+// after optimizeRepresentation().
+
+// G(n, m): `edges` distinct random pairs, no self loops.
+Graph erdosRenyi(uint32_t size, uint64_t edges, GeneratorOptions const& options = GeneratorOptions{}) noexcept(false);
+
+// R-MAT / Kronecker with 2^scale nodes and edgeFactor * 2^scale edge draws; d = 1 - a - b - c.
+Graph rmat(uint32_t scale, uint32_t edgeFactor, GeneratorOptions const& options = GeneratorOptions{},
+           double a = 0.57, double b = 0.19, double c = 0.19) noexcept(false);
+
+// Road-like lattice: 4-neighbour grid plus a `shortcuts` share of random diagonal links.
+Graph grid(uint32_t rows, uint32_t columns, GeneratorOptions const& options = GeneratorOptions{}, double shortcuts = 0.0) noexcept(false);
+
+// Barabasi-Albert preferential attachment, each new node linking to `edgesPerNode` existing ones.
+Graph powerLaw(uint32_t size, uint32_t edgesPerNode, GeneratorOptions const& options = GeneratorOptions{}) noexcept(false);
+
+}
+
+}
+
+#endif // GENERATORS_H
@@ -1,4 +1,10 @@
 #include "graph.h"
+#include "instrumentation.h"
+#include "parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
 #include <stdexcept>
 
 namespace Graphs
@@ -6,15 +12,288 @@ namespace Graphs
 
 constexpr edge_weight_type Graph::noConnection;
 
-Graph::Graph() : m_matrix(), m_nodesCount(0) { }
+static uint64_t nextVersion() noexcept
+{
+    static std::atomic<uint64_t> counter{0};
+    return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+// Bytes a sparse row spends per edge; a dense row costs sizeof(edge_weight_type) per node.
+constexpr std::size_t sparseEdgeBytes = sizeof(Node::integral_type) + sizeof(edge_weight_type);
+
+std::size_t MemoryUsage::getTotal() const noexcept
+{
+    return adjacency + weights + labels + indices;
+}
 
-Graph::Graph(uint32_t size) : m_matrix(size, std::vector<edge_weight_type>(size, noConnection)), m_nodesCount(size) { }
+Graph::Graph() : Graph(0) { }
+
+Graph::Graph(uint32_t size) : Graph(size, GraphRepresentation::Dense) { }
+
+Graph::Graph(uint32_t size, GraphRepresentation representation)
+    : m_representation(representation), m_matrix(), m_rows(), m_bits(), m_uniformWeight(noConnection), m_nodesCount(size),
+      m_version(nextVersion()), m_outDegrees(size, 0), m_inDegrees(size, 0), m_edgesCount(0)
+{
+    switch (representation)
+    {
+    case GraphRepresentation::Dense:
+        m_matrix.assign(size, std::vector<edge_weight_type>(size, noConnection));
+        break;
+    case GraphRepresentation::Bitset:
+        m_bits.assign(size * getRowWords(), 0);
+        break;
+    case GraphRepresentation::Hybrid:
+        m_matrix.resize(size);
+        m_rows.resize(size);
+        break;
+    case GraphRepresentation::Sparse:
+        m_rows.resize(size);
+        break;
+    }
+}
 
 uint32_t Graph::getSize() const noexcept
 {
     return m_nodesCount;
 }
 
+uint64_t Graph::getVersion() const noexcept
+{
+    return m_version;
+}
+
+GraphRepresentation Graph::getRepresentation() const noexcept
+{
+    return m_representation;
+}
+
+void Graph::setRepresentation(GraphRepresentation representation) noexcept(false)
+{
+    if (representation == m_representation)
+    {
+        return;
+    }
+    if (representation == GraphRepresentation::Bitset && !hasUniformWeights())
+    {
+        throw std::invalid_argument("Bitset representation requires all edges to have the same weight");
+    }
+
+    Graph converted{m_nodesCount, representation};
+    std::vector<uint32_t> const& degrees = m_outDegrees;
+    for (Node::integral_type src = 0; src < m_nodesCount; ++src)
+    {
+        if (representation == GraphRepresentation::Hybrid && degrees[src] * sparseEdgeBytes > m_nodesCount * sizeof(edge_weight_type))
+        {
+            converted.m_matrix[src].assign(m_nodesCount, noConnection);
+        }
+        else if (!converted.isDenseRow(src) && representation != GraphRepresentation::Bitset)
+        {
+            converted.m_rows[src].targets.reserve(degrees[src]);
+            converted.m_rows[src].weights.reserve(degrees[src]);
+        }
+        forEachEdge(src, [&converted, src](Node::integral_type target, edge_weight_type weight)
+        {
+            converted.setCell(src, target, weight);
+        });
+    }
+    m_representation = representation;
+    m_matrix = std::move(converted.m_matrix);
+    m_rows = std::move(converted.m_rows);
+    m_bits = std::move(converted.m_bits);
+    m_uniformWeight = converted.m_uniformWeight;
+}
+
+void Graph::optimizeRepresentation()
+{
+    std::size_t nodes = m_nodesCount;
+    std::size_t hybrid = nodes * (sizeof(std::vector<edge_weight_type>) + sizeof(SparseRow));
+    for (uint32_t degree : m_outDegrees)
+    {
+        hybrid += std::min(nodes * sizeof(edge_weight_type), degree * sparseEdgeBytes);
+    }
+    uint64_t edges = m_edgesCount;
+
+    GraphRepresentation best = chooseRepresentation(m_nodesCount, edges, hasUniformWeights());
+    std::size_t bestBytes = 0;
+    switch (best)
+    {
+    case GraphRepresentation::Dense:
+        bestBytes = nodes * (sizeof(std::vector<edge_weight_type>) + nodes * sizeof(edge_weight_type));
+        break;
+    case GraphRepresentation::Bitset:
+        bestBytes = nodes * getRowWords() * sizeof(uint64_t);
+        break;
+    default:
+        bestBytes = nodes * sizeof(SparseRow) + edges * sparseEdgeBytes;
+        break;
+    }
+    setRepresentation(hybrid < bestBytes ? GraphRepresentation::Hybrid : best);
+}
+
+GraphRepresentation Graph::chooseRepresentation(uint32_t nodes, uint64_t edges, bool uniformWeights) noexcept
+{
+    double size = nodes;
+    double dense = size * (sizeof(std::vector<edge_weight_type>) + size * sizeof(edge_weight_type));
+    double bitset = size * std::ceil(size / 64) * sizeof(uint64_t);
+    double sparse = size * sizeof(SparseRow) + static_cast<double>(edges) * sparseEdgeBytes;
+    if (uniformWeights && bitset < dense && bitset < sparse)
+    {
+        return GraphRepresentation::Bitset;
+    }
+    return sparse < dense ? GraphRepresentation::Sparse : GraphRepresentation::Dense;
+}
+
+MemoryUsage Graph::memoryUsage() const noexcept
+{
+    MemoryUsage usage{0, 0, 0, sizeof(Graph)};
+    usage.indices += m_matrix.capacity() * sizeof(std::vector<edge_weight_type>) + m_rows.capacity() * sizeof(SparseRow);
+    for (auto&& row : m_matrix)
+    {
+        usage.adjacency += row.capacity() * sizeof(edge_weight_type);
+    }
+    for (auto&& row : m_rows)
+    {
+        usage.adjacency += row.targets.capacity() * sizeof(Node::integral_type);
+        usage.weights += row.weights.capacity() * sizeof(edge_weight_type);
+    }
+    usage.adjacency += m_bits.capacity() * sizeof(uint64_t);
+    usage.indices += (m_outDegrees.capacity() + m_inDegrees.capacity()) * sizeof(uint32_t);
+    return usage;
+}
+
+bool Graph::isDenseRow(Node::integral_type node) const noexcept
+{
+    return node < m_matrix.size() && !m_matrix[node].empty();
+}
+
+std::size_t Graph::getRowWords() const noexcept
+{
+    return (static_cast<std::size_t>(m_nodesCount) + 63) / 64;
+}
+
+edge_weight_type Graph::getCell(Node::integral_type src, Node::integral_type target) const noexcept
+{
+    if (m_representation == GraphRepresentation::Bitset)
+    {
+        uint64_t word = m_bits[src * getRowWords() + target / 64];
+        return ((word >> (target % 64)) & 1U) != 0 ? m_uniformWeight : noConnection;
+    }
+    else if (isDenseRow(src))
+    {
+        return m_matrix[src][target];
+    }
+    SparseRow const& row = m_rows[src];
+    auto iter = std::lower_bound(row.targets.begin(), row.targets.end(), target);
+    if (iter == row.targets.end() || *iter != target)
+    {
+        return noConnection;
+    }
+    return row.weights[static_cast<std::size_t>(iter - row.targets.begin())];
+}
+
+// Writing noConnection removes the edge, as it always did for the dense matrix.
+void Graph::setCell(Node::integral_type src, Node::integral_type target, edge_weight_type weight)
+{
+    if (m_representation == GraphRepresentation::Bitset)
+    {
+        if (weight != noConnection && weight != m_uniformWeight)
+        {
+            if (m_uniformWeight == noConnection)
+            {
+                m_uniformWeight = weight;
+            }
+            else
+            {
+                // A second distinct weight: the graph no longer fits in presence bits.
+                GraphRepresentation representation = chooseRepresentation(m_nodesCount, m_edgesCount + 1, false);
+                setRepresentation(representation);
+                setCell(src, target, weight);
+                return;
+            }
+        }
+        uint64_t& word = m_bits[src * getRowWords() + target / 64];
+        uint64_t mask = uint64_t{1} << (target % 64);
+        countEdge(src, target, (word & mask) != 0, weight != noConnection);
+        word = weight != noConnection ? (word | mask) : (word & ~mask);
+        return;
+    }
+    else if (isDenseRow(src))
+    {
+        countEdge(src, target, m_matrix[src][target] != noConnection, weight != noConnection);
+        m_matrix[src][target] = weight;
+        return;
+    }
+
+    SparseRow& row = m_rows[src];
+    auto iter = std::lower_bound(row.targets.begin(), row.targets.end(), target);
+    std::size_t position = static_cast<std::size_t>(iter - row.targets.begin());
+    if (iter != row.targets.end() && *iter == target)
+    {
+        if (weight == noConnection)
+        {
+            countEdge(src, target, true, false);
+            row.targets.erase(iter);
+            row.weights.erase(row.weights.begin() + static_cast<std::ptrdiff_t>(position));
+        }
+        else
+        {
+            row.weights[position] = weight;
+        }
+        return;
+    }
+    else if (weight == noConnection)
+    {
+        return;
+    }
+    countEdge(src, target, false, true);
+    row.targets.insert(iter, target);
+    row.weights.insert(row.weights.begin() + static_cast<std::ptrdiff_t>(position), weight);
+
+    if (m_representation == GraphRepresentation::Hybrid && row.targets.size() * sparseEdgeBytes > m_nodesCount * sizeof(edge_weight_type))
+    {
+        std::vector<edge_weight_type> dense(m_nodesCount, noConnection);
+        for (std::size_t index = 0; index < row.targets.size(); ++index)
+        {
+            dense[row.targets[index]] = row.weights[index];
+        }
+        m_matrix[src] = std::move(dense);
+        row = SparseRow{};
+    }
+}
+
+void Graph::countEdge(Node::integral_type src, Node::integral_type target, bool existed, bool exists) noexcept
+{
+    if (existed != exists)
+    {
+        int32_t change = exists ? 1 : -1;
+        m_outDegrees[src] += static_cast<uint32_t>(change);
+        m_inDegrees[target] += static_cast<uint32_t>(change);
+        m_edgesCount += static_cast<uint64_t>(static_cast<int64_t>(change));
+    }
+}
+
+bool Graph::hasUniformWeights() const noexcept
+{
+    if (m_representation == GraphRepresentation::Bitset)
+    {
+        return true;
+    }
+    edge_weight_type first = noConnection;
+    bool uniform = true;
+    for (Node::integral_type src = 0; src < m_nodesCount && uniform; ++src)
+    {
+        forEachEdge(src, [&first, &uniform](Node::integral_type, edge_weight_type weight)
+        {
+            if (first == noConnection)
+            {
+                first = weight;
+            }
+            uniform = uniform && weight == first;
+        });
+    }
+    return uniform;
+}
+
 bool Graph::contains(Node::integral_type node) const noexcept
 {
     return (node < m_nodesCount);
@@ -25,13 +304,46 @@ bool Graph::contains(Node const& node) const noexcept
     return contains(node.id);
 }
 
+uint64_t Graph::getEdgesCount() const noexcept
+{
+    return m_edgesCount;
+}
+
+uint32_t Graph::getOutDegree(Node::integral_type node) const noexcept(false)
+{
+    if (!contains(node))
+    {
+        throw std::invalid_argument("Node does not exist");
+    }
+    return m_outDegrees[node];
+}
+
+uint32_t Graph::getInDegree(Node::integral_type node) const noexcept(false)
+{
+    if (!contains(node))
+    {
+        throw std::invalid_argument("Node does not exist");
+    }
+    return m_inDegrees[node];
+}
+
+std::vector<uint32_t> const& Graph::getOutDegrees() const noexcept
+{
+    return m_outDegrees;
+}
+
+std::vector<uint32_t> const& Graph::getInDegrees() const noexcept
+{
+    return m_inDegrees;
+}
+
 bool Graph::areNodesConnected(Node::integral_type first, Node::integral_type second) const noexcept(false)
 {
     if (!contains(first) || !contains(second))
     {
         throw std::invalid_argument("Could not check connection between non-existing nodes");
     }
-    return (m_matrix[first][second] != noConnection);
+    return (getCell(first, second) != noConnection);
 }
 
 bool Graph::areNodesConnected(Node const& first, Node const& second) const noexcept(false)
@@ -46,11 +358,12 @@ Edge Graph::insertEdge(Node::integral_type src, Node::integral_type target, Edge
         throw std::invalid_argument("Could not insert an edge between non-existing nodes");
     }
 
-    m_matrix[src][target] = 0;
+    setCell(src, target, 0);
     if (direction == EdgeDirection::Undirected)
     {
-        m_matrix[target][src] = 0;
+        setCell(target, src, 0);
     }
+    m_version = nextVersion();
     return Edge{Node{src}, Node{target}, 0, direction};
 }
 
@@ -66,11 +379,12 @@ Edge Graph::insertEdge(Node::integral_type src, Node::integral_type target, edge
         throw std::invalid_argument("Could not insert an edge between non-existing nodes");
     }
 
-    m_matrix[src][target] = weight;
+    setCell(src, target, weight);
     if (direction == EdgeDirection::Undirected)
     {
-        m_matrix[target][src] = weight;
+        setCell(target, src, weight);
     }
+    m_version = nextVersion();
     return Edge{Node{src}, Node{target}, weight, direction};
 }
 
@@ -86,15 +400,16 @@ std::vector<Node> Graph::getConnectedNodes(Node::integral_type node) const noexc
         throw std::invalid_argument("Node does not exist");
     }
 
+    bool sparse = m_representation != GraphRepresentation::Bitset && !isDenseRow(node);
+    // Dense and bitset rows are scanned in full whatever the degree, which is what makes this call expensive.
+    GRAPHS_INSTRUMENT_COUNT(EdgesScanned, sparse ? m_rows[node].targets.size() : m_nodesCount);
+    GRAPHS_INSTRUMENT_COUNT(Allocations, 1);
     std::vector<Node> ret;
-    ret.reserve(m_nodesCount);
-    for (Node::integral_type id = 0; id < m_nodesCount; ++id)
+    ret.reserve(sparse ? m_rows[node].targets.size() : m_nodesCount);
+    forEachEdge(node, [&ret](Node::integral_type target, edge_weight_type)
     {
-        if (areNodesConnected(node, id))
-        {
-            ret.push_back(Node{id});
-        }
-    }
+        ret.push_back(Node{target});
+    });
     ret.shrink_to_fit();
     return ret;
 }
@@ -123,8 +438,9 @@ Edge const Graph::getEdge(Node::integral_type src, Node::integral_type target) c
     {
         throw std::invalid_argument("Nodes are not connected");
     }
-    return Edge{Node{src}, Node{target}, m_matrix[src][target],
-                m_matrix[src][target] == m_matrix[target][src] ? EdgeDirection::Undirected : EdgeDirection::Directed};
+    edge_weight_type weight = getCell(src, target);
+    return Edge{Node{src}, Node{target}, weight,
+                weight == getCell(target, src) ? EdgeDirection::Undirected : EdgeDirection::Directed};
 }
 
 Edge const Graph::getEdge(Node const& src, Node const& target) const noexcept(false)
@@ -138,7 +454,7 @@ edge_weight_type Graph::getEdgeWeight(Node::integral_type src, Node::integral_ty
     {
         throw std::invalid_argument("Nodes do not exist");
     }
-    return m_matrix[src][target];
+    return getCell(src, target);
 }
 
 edge_weight_type Graph::getEdgeWeight(Node const& src, Node const& target) const noexcept(false)
@@ -146,8 +462,118 @@ edge_weight_type Graph::getEdgeWeight(Node const& src, Node const& target) const
     return getEdgeWeight(src.id, target.id);
 }
 
+Graph Graph::induce(std::vector<Node::integral_type> const& nodes,
+                    std::unordered_map<Node::integral_type, Node::integral_type> const& localIds) const
+{
+    Graph subgraph{static_cast<uint32_t>(nodes.size()), GraphRepresentation::Sparse};
+    std::vector<std::pair<Node::integral_type, edge_weight_type>> row;
+    for (Node::integral_type local = 0; local < nodes.size(); ++local)
+    {
+        Node::integral_type node = nodes[local];
+        row.clear();
+        if (m_representation != GraphRepresentation::Bitset && !isDenseRow(node))
+        {
+            SparseRow const& source = m_rows[node];
+            GRAPHS_INSTRUMENT_COUNT(EdgesScanned, source.targets.size());
+            for (std::size_t index = 0; index < source.targets.size(); ++index)
+            {
+                auto found = localIds.find(source.targets[index]);
+                if (found != localIds.end())
+                {
+                    row.emplace_back(found->second, source.weights[index]);
+                }
+            }
+            std::sort(row.begin(), row.end());
+        }
+        else
+        {
+            // Probing the selected nodes is cheaper than scanning a full matrix row.
+            GRAPHS_INSTRUMENT_COUNT(EdgesScanned, nodes.size());
+            for (Node::integral_type target = 0; target < nodes.size(); ++target)
+            {
+                edge_weight_type weight = getCell(node, nodes[target]);
+                if (weight != noConnection)
+                {
+                    row.emplace_back(target, weight);
+                }
+            }
+        }
+        SparseRow& destination = subgraph.m_rows[local];
+        destination.targets.reserve(row.size());
+        destination.weights.reserve(row.size());
+        for (auto&& edge : row)
+        {
+            destination.targets.push_back(edge.first);
+            destination.weights.push_back(edge.second);
+            subgraph.countEdge(local, edge.first, false, true);
+        }
+    }
+    subgraph.optimizeRepresentation();
+    return subgraph;
+}
+
+Subgraph Graph::extractInducedSubgraph(std::vector<Node::integral_type> const& nodes) const noexcept(false)
+{
+    GRAPHS_INSTRUMENT_SCOPE("Graph::extractInducedSubgraph");
+    std::unordered_map<Node::integral_type, Node::integral_type> localIds;
+    localIds.reserve(nodes.size());
+    for (Node::integral_type local = 0; local < nodes.size(); ++local)
+    {
+        if (!contains(nodes[local]))
+        {
+            throw std::invalid_argument("Node does not exist");
+        }
+        else if (!localIds.emplace(nodes[local], local).second)
+        {
+            throw std::invalid_argument("Node is selected more than once");
+        }
+    }
+    return Subgraph{induce(nodes, localIds), nodes};
+}
+
+Subgraph Graph::extractEgoNetwork(Node::integral_type center, uint32_t hops) const noexcept(false)
+{
+    if (!contains(center))
+    {
+        throw std::invalid_argument("Node does not exist");
+    }
+    GRAPHS_INSTRUMENT_SCOPE("Graph::extractEgoNetwork");
+    std::vector<Node::integral_type> nodes{center};
+    std::unordered_map<Node::integral_type, Node::integral_type> localIds{{center, 0}};
+    std::size_t levelBegin = 0;
+    for (uint32_t hop = 0; hop < hops && levelBegin < nodes.size(); ++hop)
+    {
+        std::size_t levelEnd = nodes.size();
+        for (std::size_t index = levelBegin; index < levelEnd; ++index)
+        {
+            GRAPHS_INSTRUMENT_COUNT(NodesVisited, 1);
+            forEachEdge(nodes[index], [&nodes, &localIds](Node::integral_type target, edge_weight_type)
+            {
+                if (localIds.emplace(target, static_cast<Node::integral_type>(nodes.size())).second)
+                {
+                    nodes.push_back(target);
+                }
+            });
+        }
+        levelBegin = levelEnd;
+    }
+    return Subgraph{induce(nodes, localIds), std::move(nodes)};
+}
+
+std::vector<Subgraph> Graph::extractEgoNetworks(std::vector<Node::integral_type> const& centers, uint32_t hops,
+                                                unsigned threads) const noexcept(false)
+{
+    std::vector<Subgraph> subgraphs(centers.size());
+    Parallel::forEach(centers.size(), threads, [this, &centers, &subgraphs, hops](unsigned, std::size_t index)
+    {
+        subgraphs[index] = extractEgoNetwork(centers[index], hops);
+    }, 1);
+    return subgraphs;
+}
+
 std::string Graph::serialize() const
 {
+    GRAPHS_INSTRUMENT_SCOPE("Graph::serialize");
     QString xml;
     QXmlStreamWriter xmlWriter(&xml);
     xmlWriter.setAutoFormatting(true);
@@ -179,7 +605,9 @@ std::string Graph::serialize() const
 
 void Graph::fromXml(const std::string &xml)
 {
+    GRAPHS_INSTRUMENT_SCOPE("Graph::fromXml");
     QXmlStreamReader xmlReader(QString::fromStdString(xml));
+    m_version = nextVersion();
 
     xmlReader.readNext();
     while (!xmlReader.atEnd())
@@ -193,7 +621,16 @@ void Graph::fromXml(const std::string &xml)
                     if (attribute.name().toString() == "size")
                     {
                         uint32_t size = attribute.value().toUInt();
-                        m_matrix = std::vector<std::vector<edge_weight_type>>(size, std::vector<edge_weight_type>(size, noConnection));
+                        // Load into sparse rows, then settle on a representation once the edges are known.
+                        m_representation = GraphRepresentation::Sparse;
+                        m_matrix.clear();
+                        m_bits.clear();
+                        m_rows = std::vector<SparseRow>(size);
+                        m_uniformWeight = noConnection;
+                        m_outDegrees.assign(size, 0);
+                        m_inDegrees.assign(size, 0);
+                        m_edgesCount = 0;
+                        GRAPHS_INSTRUMENT_COUNT(Allocations, 1);
                         m_nodesCount = {size};
                     }
                 }
@@ -228,10 +665,22 @@ void Graph::fromXml(const std::string &xml)
                                 }
                                 else if (attrName == "weight")
                                 {
-                                    weight = attribute.value().toUInt();
+                                    // Signed, so negative weights survive a serialize() round trip.
+                                    bool parsed = false;
+                                    int value = attribute.value().toInt(&parsed);
+                                    if (!parsed || value <= std::numeric_limits<edge_weight_type>::min()
+                                        || value > std::numeric_limits<edge_weight_type>::max())
+                                    {
+                                        throw std::runtime_error("Edge weight is not a valid 16-bit weight");
+                                    }
+                                    weight = static_cast<edge_weight_type>(value);
                                 }
                             }
-                            m_matrix[src.id][sink.id] = weight;
+                            if (!contains(src) || !contains(sink))
+                            {
+                                throw std::runtime_error("Edge refers to a non-existing node");
+                            }
+                            setCell(src.id, sink.id, weight);
                         }
                         xmlReader.readNext();
                     }
@@ -256,6 +705,7 @@ void Graph::fromXml(const std::string &xml)
     {
         throw std::runtime_error(xmlReader.errorString().toStdString());
     }
+    optimizeRepresentation();
 }
 
 }
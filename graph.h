@@ -3,22 +3,79 @@
 
 #include <vector>
 #include <limits>
+#include <unordered_map>
+#include <cstddef>
 #include "commontypes.hpp"
 #include "iserializable.h"
 
 namespace Graphs
 {
 
+enum class GraphRepresentation : uint8_t
+{
+    Dense,  // V x V weight matrix, O(1) edge lookup
+    Bitset, // V x V presence bits and a single weight shared by every edge
+    Sparse, // per-node neighbour and weight arrays sorted by target id
+    Hybrid  // dense rows for nodes of high degree, sparse rows for the rest
+};
+
+// Heap and object bytes held by a graph. Dense cells carry their weight inline and are counted as adjacency.
+struct MemoryUsage
+{
+    std::size_t adjacency;
+    std::size_t weights;
+    std::size_t labels;
+    std::size_t indices;
+
+    std::size_t getTotal() const noexcept;
+};
+
+struct Subgraph;
+
 class Graph : public IXmlSerializable
 {
+    friend class AdjacencyList;
+
 private:
+    struct SparseRow
+    {
+        std::vector<Node::integral_type> targets;
+        std::vector<edge_weight_type> weights;
+    };
+
+    GraphRepresentation m_representation;
+    // Dense rows. A Hybrid graph keeps an empty row here for every node stored in m_rows instead.
     std::vector<std::vector<edge_weight_type>> m_matrix;
+    std::vector<SparseRow> m_rows;
+    std::vector<uint64_t> m_bits;
+    edge_weight_type m_uniformWeight;
     uint32_t m_nodesCount;
+    uint64_t m_version;
+    // Maintained by setCell(), so degrees never require scanning the storage.
+    std::vector<uint32_t> m_outDegrees;
+    std::vector<uint32_t> m_inDegrees;
+    uint64_t m_edgesCount;
     static constexpr edge_weight_type noConnection = std::numeric_limits<edge_weight_type>::min();
 
+    bool isDenseRow(Node::integral_type node) const noexcept;
+    std::size_t getRowWords() const noexcept;
+    edge_weight_type getCell(Node::integral_type src, Node::integral_type target) const noexcept;
+    void setCell(Node::integral_type src, Node::integral_type target, edge_weight_type weight);
+    bool hasUniformWeights() const noexcept;
+    // Keeps the degree counters in step with a cell going from `existed` to `exists`.
+    void countEdge(Node::integral_type src, Node::integral_type target, bool existed, bool exists) noexcept;
+
+    // Calls visit(target, weight) for every outgoing edge of `src`, in increasing target order.
+    template <typename Visitor>
+    void forEachEdge(Node::integral_type src, Visitor&& visit) const;
+    // Sparse graph of the edges among `nodes`, node i standing for nodes[i]; localIds is the inverse mapping.
+    Graph induce(std::vector<Node::integral_type> const& nodes,
+                 std::unordered_map<Node::integral_type, Node::integral_type> const& localIds) const;
+
 public:
     Graph();
     Graph(uint32_t size);
+    Graph(uint32_t size, GraphRepresentation representation);
     Graph(Graph const&) = default;
     Graph(Graph&&) = default;
     Graph& operator=(Graph const&) = default;
@@ -26,10 +83,31 @@ public:
     ~Graph() = default;
 
     uint32_t getSize() const noexcept;
+    // Changes on every mutation; values are unique process-wide, so equal versions imply equal contents.
+    uint64_t getVersion() const noexcept;
+
+    GraphRepresentation getRepresentation() const noexcept;
+    // Converts the storage without changing the graph; Bitset requires every edge to have the same weight.
+    void setRepresentation(GraphRepresentation representation) noexcept(false);
+    // Switches to the representation chooseRepresentation() estimates to be the smallest for the current edges.
+    // fromXml() does this after loading.
+    void optimizeRepresentation();
+    MemoryUsage memoryUsage() const noexcept;
+
+    // Cheapest representation for a graph of the given shape, assuming evenly spread degrees. Hybrid only pays
+    // off for skewed degrees, so it is picked by optimizeRepresentation(), which sees the real distribution.
+    static GraphRepresentation chooseRepresentation(uint32_t nodes, uint64_t edges, bool uniformWeights) noexcept;
 
     bool contains(Node::integral_type node) const noexcept;
     bool contains(Node const& node) const noexcept;
 
+    // Stored edges, an undirected edge counting once in each direction.
+    uint64_t getEdgesCount() const noexcept;
+    uint32_t getOutDegree(Node::integral_type node) const noexcept(false);
+    uint32_t getInDegree(Node::integral_type node) const noexcept(false);
+    std::vector<uint32_t> const& getOutDegrees() const noexcept;
+    std::vector<uint32_t> const& getInDegrees() const noexcept;
+
     bool areNodesConnected(Node::integral_type first, Node::integral_type second) const noexcept(false);
     bool areNodesConnected(Node const& first, Node const& second) const noexcept(false);
 
@@ -49,10 +127,64 @@ public:
     edge_weight_type getEdgeWeight(Node::integral_type src, Node::integral_type target) const noexcept(false);
     edge_weight_type getEdgeWeight(Node const& src, Node const& target) const noexcept(false);
 
+    // Bulk extraction into a new graph holding only the selected nodes, with weights and directions kept.
+    // Cost follows the degrees of the selected nodes rather than the size of this graph, except that
+    // finding the neighbours of a dense or bitset row still scans the row.
+    Subgraph extractInducedSubgraph(std::vector<Node::integral_type> const& nodes) const noexcept(false);
+    // Nodes reachable from `center` over at most `hops` outgoing edges, in breadth-first order starting with
+    // the center, and every edge among them.
+    Subgraph extractEgoNetwork(Node::integral_type center, uint32_t hops) const noexcept(false);
+    // extractEgoNetwork() for every center, computed in parallel; results follow the order of `centers`.
+    std::vector<Subgraph> extractEgoNetworks(std::vector<Node::integral_type> const& centers, uint32_t hops,
+                                             unsigned threads = 0) const noexcept(false);
+
     std::string serialize() const override;
     void fromXml(std::string const& xml) override;
 };
 
+// Part of a larger graph: node i of `graph` is node localToGlobal[i] of the graph it was extracted from.
+struct Subgraph
+{
+    Graph graph;
+    std::vector<Node::integral_type> localToGlobal;
+};
+
+template <typename Visitor>
+void Graph::forEachEdge(Node::integral_type src, Visitor&& visit) const
+{
+    if (m_representation == GraphRepresentation::Bitset)
+    {
+        std::size_t words = getRowWords();
+        uint64_t const* row = m_bits.data() + src * words;
+        for (std::size_t word = 0; word < words; ++word)
+        {
+            for (uint64_t bits = row[word]; bits != 0; bits &= bits - 1)
+            {
+                visit(static_cast<Node::integral_type>(word * 64 + __builtin_ctzll(bits)), m_uniformWeight);
+            }
+        }
+    }
+    else if (isDenseRow(src))
+    {
+        std::vector<edge_weight_type> const& row = m_matrix[src];
+        for (Node::integral_type target = 0; target < m_nodesCount; ++target)
+        {
+            if (row[target] != noConnection)
+            {
+                visit(target, row[target]);
+            }
+        }
+    }
+    else
+    {
+        SparseRow const& row = m_rows[src];
+        for (std::size_t index = 0; index < row.targets.size(); ++index)
+        {
+            visit(row.targets[index], row.weights[index]);
+        }
+    }
+}
+
 }
 
 #endif // GRAPH_H
@@ -0,0 +1,67 @@
+# qmake CONFIG+=instrumentation compiles in the hot-path counters and trace scopes (see instrumentation.h).
+instrumentation {
+    DEFINES += GRAPHS_INSTRUMENTATION
+}
+
+SOURCES += \
+    graph.cpp \
+    algorithms.cpp \
+    commontypes.cpp \
+    labeledgraph.cpp \
+    adjacencylist.cpp \
+    centrality.cpp \
+    triangles.cpp \
+    spanningtree.cpp \
+    disjointsets.cpp \
+    maximumflow.cpp \
+    dag.cpp \
+    deltastepping.cpp \
+    reordering.cpp \
+    threadpool.cpp \
+    queryengine.cpp \
+    queryserver.cpp \
+    pathcache.cpp \
+    generators.cpp \
+    instrumentation.cpp \
+    compressedadjacency.cpp \
+    journal.cpp \
+    partitioning.cpp \
+    diskadjacency.cpp \
+    kshortestpaths.cpp \
+    kcore.cpp \
+    randomwalks.cpp \
+    labelindex.cpp \
+    fileio.cpp
+
+HEADERS += \
+    graph.h \
+    algorithms.h \
+    commontypes.hpp \
+    labeledgraph.h \
+    iserializable.h \
+    parallel.h \
+    adjacencylist.h \
+    centrality.h \
+    triangles.h \
+    spanningtree.h \
+    disjointsets.h \
+    maximumflow.h \
+    dag.h \
+    deltastepping.h \
+    reordering.h \
+    versionedgraph.h \
+    threadpool.h \
+    queryengine.h \
+    queryserver.h \
+    pathcache.h \
+    generators.h \
+    instrumentation.h \
+    compressedadjacency.h \
+    journal.h \
+    partitioning.h \
+    diskadjacency.h \
+    kshortestpaths.h \
+    kcore.h \
+    randomwalks.h \
+    labelindex.h \
+    fileio.h
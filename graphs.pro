@@ -1,17 +1,8 @@
 TEMPLATE = app
-CONFIG += console c++14 qt
+CONFIG += console c++14 qt thread
 CONFIG -= app_bundle
 QT+=xml
 
-SOURCES += main.cpp \
-    graph.cpp \
-    algorithms.cpp \
-    commontypes.cpp \
-    labeledgraph.cpp
+include(graphs.pri)
 
-HEADERS += \
-    graph.h \
-    algorithms.h \
-    commontypes.hpp \
-    labeledgraph.h \
-    iserializable.h
+SOURCES += main.cpp
@@ -0,0 +1,299 @@
+#include "instrumentation.h"
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace Graphs
+{
+
+namespace Instrumentation
+{
+
+namespace
+{
+
+constexpr std::size_t maxTraceEventsPerThread = 1U << 18;
+
+struct TraceEvent
+{
+    char const* name;
+    uint64_t startNanoseconds;
+    uint64_t durationNanoseconds;
+    counters_type counters;
+};
+
+struct ThreadRecord
+{
+    uint32_t thread;
+    std::mutex mutex;
+    std::unordered_map<char const*, OperationStatistics> operations;
+    std::vector<TraceEvent> events;
+};
+
+struct Registry
+{
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadRecord>> records;
+    uint32_t nextThread = 0;
+};
+
+Registry& registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+std::atomic<bool> tracing{false};
+
+std::chrono::steady_clock::time_point epoch()
+{
+    static std::chrono::steady_clock::time_point const started = std::chrono::steady_clock::now();
+    return started;
+}
+
+thread_local Scope* currentScope = nullptr;
+
+ThreadRecord& threadRecord()
+{
+    thread_local std::shared_ptr<ThreadRecord> record;
+    if (!record)
+    {
+        record = std::make_shared<ThreadRecord>();
+        Registry& instance = registry();
+        std::lock_guard<std::mutex> lock(instance.mutex);
+        record->thread = instance.nextThread++;
+        instance.records.push_back(record);
+    }
+    return *record;
+}
+
+void merge(OperationStatistics& into, OperationStatistics const& from)
+{
+    into.calls += from.calls;
+    into.totalNanoseconds += from.totalNanoseconds;
+    into.maxNanoseconds = std::max(into.maxNanoseconds, from.maxNanoseconds);
+    for (std::size_t index = 0; index < countersCount; ++index)
+    {
+        into.counters[index] += from.counters[index];
+    }
+}
+
+void writeCounters(std::ostream& out, counters_type const& counters)
+{
+    for (std::size_t index = 0; index < countersCount; ++index)
+    {
+        out << (index == 0 ? "" : ", ") << '"' << getCounterName(static_cast<Counter>(index)) << "\": " << counters[index];
+    }
+}
+
+// Trace timestamps are microseconds; keep full nanosecond precision instead of the stream's default six digits.
+void writeMicroseconds(std::ostream& out, uint64_t nanoseconds)
+{
+    char fraction[4] = {static_cast<char>('0' + nanoseconds % 1000 / 100), static_cast<char>('0' + nanoseconds % 100 / 10),
+                        static_cast<char>('0' + nanoseconds % 10), '\0'};
+    out << nanoseconds / 1000 << '.' << fraction;
+}
+
+void writeOperations(std::ostream& out, std::vector<OperationStatistics> const& operations, char const* indent)
+{
+    out << "[";
+    for (std::size_t index = 0; index < operations.size(); ++index)
+    {
+        OperationStatistics const& operation = operations[index];
+        out << (index == 0 ? "\n" : ",\n") << indent << "{\"name\": \"" << operation.name << "\", \"calls\": " << operation.calls
+            << ", \"total_ns\": " << operation.totalNanoseconds << ", \"max_ns\": " << operation.maxNanoseconds << ", ";
+        writeCounters(out, operation.counters);
+        out << "}";
+    }
+    out << "]";
+}
+
+}
+
+char const* getCounterName(Counter counter) noexcept
+{
+    switch (counter)
+    {
+    case Counter::NodesVisited:
+        return "nodes_visited";
+    case Counter::EdgesScanned:
+        return "edges_scanned";
+    case Counter::QueuePushes:
+        return "queue_pushes";
+    case Counter::QueueRepushes:
+        return "queue_repushes";
+    case Counter::Allocations:
+        return "allocations";
+    }
+    return "unknown";
+}
+
+Scope::Scope(char const* name) noexcept : m_name(name), m_parent(currentScope), m_counters(), m_started(std::chrono::steady_clock::now())
+{
+    currentScope = this;
+}
+
+Scope::~Scope()
+{
+    std::chrono::steady_clock::time_point finished = std::chrono::steady_clock::now();
+    uint64_t elapsed = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(finished - m_started).count());
+    currentScope = m_parent;
+    if (m_parent != nullptr)
+    {
+        for (std::size_t index = 0; index < countersCount; ++index)
+        {
+            m_parent->m_counters[index] += m_counters[index];
+        }
+    }
+
+    try
+    {
+        ThreadRecord& record = threadRecord();
+        std::lock_guard<std::mutex> lock(record.mutex);
+        auto inserted = record.operations.emplace(m_name, OperationStatistics{m_name, 0, 0, 0, counters_type()});
+        merge(inserted.first->second, OperationStatistics{std::string(), 1, elapsed, elapsed, m_counters});
+        if (tracing.load(std::memory_order_relaxed) && record.events.size() < maxTraceEventsPerThread)
+        {
+            uint64_t start = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(m_started - epoch()).count());
+            record.events.push_back(TraceEvent{m_name, start, elapsed, m_counters});
+        }
+    }
+    catch (...)
+    {
+        // Statistics are best effort; running out of memory here must not take the measured call down.
+    }
+}
+
+void Scope::add(Counter counter, uint64_t amount) noexcept
+{
+    m_counters[static_cast<std::size_t>(counter)] += amount;
+}
+
+void count(Counter counter, uint64_t amount) noexcept
+{
+    if (currentScope != nullptr)
+    {
+        currentScope->add(counter, amount);
+    }
+}
+
+StatisticsSnapshot takeSnapshot()
+{
+    std::vector<std::shared_ptr<ThreadRecord>> records;
+    {
+        Registry& instance = registry();
+        std::lock_guard<std::mutex> lock(instance.mutex);
+        records = instance.records;
+    }
+
+    StatisticsSnapshot snapshot;
+    std::map<std::string, OperationStatistics> totals;
+    for (auto&& record : records)
+    {
+        std::map<std::string, OperationStatistics> operations;
+        {
+            std::lock_guard<std::mutex> lock(record->mutex);
+            for (auto&& entry : record->operations)
+            {
+                auto inserted = operations.emplace(entry.second.name, OperationStatistics{entry.second.name, 0, 0, 0, counters_type()});
+                merge(inserted.first->second, entry.second);
+            }
+        }
+        if (operations.empty())
+        {
+            continue;
+        }
+        ThreadStatistics thread{record->thread, {}};
+        for (auto&& entry : operations)
+        {
+            auto inserted = totals.emplace(entry.first, OperationStatistics{entry.first, 0, 0, 0, counters_type()});
+            merge(inserted.first->second, entry.second);
+            thread.operations.push_back(std::move(entry.second));
+        }
+        snapshot.threads.push_back(std::move(thread));
+    }
+    for (auto&& entry : totals)
+    {
+        snapshot.totals.push_back(std::move(entry.second));
+    }
+    return snapshot;
+}
+
+void reset() noexcept
+{
+    Registry& instance = registry();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+    // Records only referenced from here belong to threads that have exited.
+    instance.records.erase(std::remove_if(instance.records.begin(), instance.records.end(),
+                                          [](std::shared_ptr<ThreadRecord> const& record) { return record.use_count() == 1; }),
+                           instance.records.end());
+    for (auto&& record : instance.records)
+    {
+        std::lock_guard<std::mutex> recordLock(record->mutex);
+        record->operations.clear();
+        record->events.clear();
+    }
+}
+
+void setTracingEnabled(bool enabled) noexcept
+{
+    epoch();
+    tracing.store(enabled, std::memory_order_relaxed);
+}
+
+bool isTracingEnabled() noexcept
+{
+    return tracing.load(std::memory_order_relaxed);
+}
+
+void writeStatistics(std::ostream& out, StatisticsSnapshot const& snapshot)
+{
+    out << "{\n  \"enabled\": " << (isEnabled() ? "true" : "false") << ",\n  \"threads\": [";
+    for (std::size_t index = 0; index < snapshot.threads.size(); ++index)
+    {
+        out << (index == 0 ? "\n" : ",\n") << "    {\"thread\": " << snapshot.threads[index].thread << ", \"operations\": ";
+        writeOperations(out, snapshot.threads[index].operations, "      ");
+        out << "}";
+    }
+    out << "],\n  \"totals\": ";
+    writeOperations(out, snapshot.totals, "    ");
+    out << "\n}\n";
+}
+
+void writeChromeTrace(std::ostream& out)
+{
+    std::vector<std::shared_ptr<ThreadRecord>> records;
+    {
+        Registry& instance = registry();
+        std::lock_guard<std::mutex> lock(instance.mutex);
+        records = instance.records;
+    }
+
+    out << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+    bool first = true;
+    for (auto&& record : records)
+    {
+        std::lock_guard<std::mutex> lock(record->mutex);
+        for (auto&& event : record->events)
+        {
+            out << (first ? "\n" : ",\n") << "{\"name\": \"" << event.name << "\", \"cat\": \"graphs\", \"ph\": \"X\", \"pid\": 1, \"tid\": "
+                << record->thread << ", \"ts\": ";
+            writeMicroseconds(out, event.startNanoseconds);
+            out << ", \"dur\": ";
+            writeMicroseconds(out, event.durationNanoseconds);
+            out << ", \"args\": {";
+            writeCounters(out, event.counters);
+            out << "}}";
+            first = false;
+        }
+    }
+    out << "\n]}\n";
+}
+
+}
+
+}
@@ -0,0 +1,115 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Opt-in hot-path instrumentation. Build with GRAPHS_INSTRUMENTATION defined (qmake CONFIG+=instrumentation)
+// to make the GRAPHS_INSTRUMENT_* macros record anything; otherwise they expand to nothing and their
+// arguments are never evaluated. The collection API below is always available and simply reports
+// nothing when the macros are compiled out.
+
+namespace Graphs
+{
+
+namespace Instrumentation
+{
+
+enum class Counter : uint8_t
+{
+    NodesVisited,
+    EdgesScanned,
+    QueuePushes,
+    QueueRepushes,
+    Allocations
+};
+
+constexpr std::size_t countersCount = 5;
+using counters_type = std::array<uint64_t, countersCount>;
+
+char const* getCounterName(Counter counter) noexcept;
+
+struct OperationStatistics
+{
+    std::string name;
+    uint64_t calls;
+    uint64_t totalNanoseconds;
+    uint64_t maxNanoseconds;
+    counters_type counters;
+};
+
+struct ThreadStatistics
+{
+    uint32_t thread;
+    std::vector<OperationStatistics> operations;
+};
+
+struct StatisticsSnapshot
+{
+    std::vector<ThreadStatistics> threads;
+    std::vector<OperationStatistics> totals;
+};
+
+constexpr bool isEnabled() noexcept
+{
+#ifdef GRAPHS_INSTRUMENTATION
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Timed region of one thread. Counters reported while a scope is the innermost one on its thread are
+// charged to it, and on exit they are added to the enclosing scope too, so totals are inclusive.
+class Scope
+{
+private:
+    char const* m_name;
+    Scope* m_parent;
+    counters_type m_counters;
+    std::chrono::steady_clock::time_point m_started;
+
+public:
+    // `name` must outlive the process, e.g. a string literal.
+    explicit Scope(char const* name) noexcept;
+    Scope(Scope const&) = delete;
+    Scope(Scope&&) = delete;
+    Scope& operator=(Scope const&) = delete;
+    Scope& operator=(Scope&&) = delete;
+    ~Scope();
+
+    void add(Counter counter, uint64_t amount) noexcept;
+};
+
+// Charges `amount` to the innermost scope of the calling thread; does nothing outside of any scope.
+void count(Counter counter, uint64_t amount = 1) noexcept;
+
+// Per-thread statistics survive their threads until reset(). Trace events are only kept while tracing
+// is enabled and are capped per thread.
+StatisticsSnapshot takeSnapshot();
+void reset() noexcept;
+void setTracingEnabled(bool enabled) noexcept;
+bool isTracingEnabled() noexcept;
+
+void writeStatistics(std::ostream& out, StatisticsSnapshot const& snapshot);
+// Writes the recorded events in the Chrome trace event format (chrome://tracing, Perfetto).
+void writeChromeTrace(std::ostream& out);
+
+}
+
+}
+
+#ifdef GRAPHS_INSTRUMENTATION
+#define GRAPHS_INSTRUMENT_SCOPE(name) ::Graphs::Instrumentation::Scope graphsInstrumentationScope(name)
+#define GRAPHS_INSTRUMENT_COUNT(counter, amount) \
+    ::Graphs::Instrumentation::count(::Graphs::Instrumentation::Counter::counter, (amount))
+#else
+#define GRAPHS_INSTRUMENT_SCOPE(name) ((void)0)
+#define GRAPHS_INSTRUMENT_COUNT(counter, amount) ((void)0)
+#endif
+
+#endif // INSTRUMENTATION_H
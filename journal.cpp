@@ -0,0 +1,430 @@
+#include "journal.h"
+#include "fileio.h"
+#include "graph.h"
+#include "labeledgraph.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Graphs
+{
+
+namespace
+{
+
+constexpr uint32_t formatVersion = 1;
+constexpr uint8_t graphKind = 1;
+constexpr uint8_t labeledGraphKind = 2;
+constexpr uint8_t insertEdgeRecord = 1;
+constexpr uint8_t setLabelRecord = 2;
+// magic, format version, kind, generation, checksum
+constexpr std::size_t journalHeaderSize = 4 + 4 + 1 + 8 + 4;
+constexpr uint64_t minimumCompactionBytes = 64 * 1024;
+
+uint32_t crc32(uint8_t const* data, std::size_t size) noexcept
+{
+    static uint32_t const* table = []
+    {
+        static uint32_t entries[256];
+        for (uint32_t index = 0; index < 256; ++index)
+        {
+            uint32_t value = index;
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                value = (value & 1U) != 0 ? 0xEDB88320U ^ (value >> 1) : value >> 1;
+            }
+            entries[index] = value;
+        }
+        return entries;
+    }();
+    uint32_t crc = 0xFFFFFFFFU;
+    for (std::size_t index = 0; index < size; ++index)
+    {
+        crc = table[(crc ^ data[index]) & 0xFFU] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFU;
+}
+
+void put16(std::vector<uint8_t>& out, uint16_t value)
+{
+    out.push_back(static_cast<uint8_t>(value));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void put32(std::vector<uint8_t>& out, uint32_t value)
+{
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        out.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+void put64(std::vector<uint8_t>& out, uint64_t value)
+{
+    for (int shift = 0; shift < 64; shift += 8)
+    {
+        out.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+uint16_t get16(uint8_t const* in)
+{
+    return static_cast<uint16_t>(in[0] | (in[1] << 8));
+}
+
+uint32_t get32(uint8_t const* in)
+{
+    return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8)
+            | (static_cast<uint32_t>(in[2]) << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+uint64_t get64(uint8_t const* in)
+{
+    return static_cast<uint64_t>(get32(in)) | (static_cast<uint64_t>(get32(in + 4)) << 32);
+}
+
+// Writes `contents` to a temporary file and renames it over `path`, so readers see the old or the new file whole.
+void replaceFile(std::string const& path, std::vector<uint8_t> const& contents)
+{
+    std::string temporary = path + ".tmp";
+    int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        throw FileIo::error("Could not create", temporary);
+    }
+    try
+    {
+        FileIo::writeAll(fd, contents.data(), contents.size(), temporary);
+        FileIo::syncFile(fd, temporary);
+    }
+    catch (...)
+    {
+        ::close(fd);
+        ::unlink(temporary.c_str());
+        throw;
+    }
+    ::close(fd);
+    if (::rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        throw FileIo::error("Could not rename", temporary);
+    }
+
+    std::string::size_type slash = path.find_last_of('/');
+    std::string directory = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+    int directoryFd = ::open(directory.c_str(), O_RDONLY | O_CLOEXEC);
+    if (directoryFd >= 0)
+    {
+        // Best effort: some file systems refuse to sync directories.
+        ::fsync(directoryFd);
+        ::close(directoryFd);
+    }
+}
+
+void applyRecord(Graph& graph, uint8_t type, uint8_t const* payload, uint32_t size)
+{
+    if (type != insertEdgeRecord || size != 11)
+    {
+        throw std::runtime_error("Unexpected record in graph journal");
+    }
+    graph.insertEdge(get32(payload), get32(payload + 4), static_cast<edge_weight_type>(get16(payload + 8)),
+                     static_cast<EdgeDirection>(payload[10]));
+}
+
+void applyRecord(LabeledGraph& graph, uint8_t type, uint8_t const* payload, uint32_t size)
+{
+    if (type == setLabelRecord && size >= 4)
+    {
+        Node::integral_type node = get32(payload);
+        if (!graph.contains(node))
+        {
+            throw std::runtime_error("Journal labels a non-existing node");
+        }
+        graph.setLabel(node, std::string(reinterpret_cast<char const*>(payload + 4), size - 4));
+        return;
+    }
+    else if (type != insertEdgeRecord || size != 11)
+    {
+        throw std::runtime_error("Unexpected record in labeled graph journal");
+    }
+    graph.insertEdge(get32(payload), get32(payload + 4), static_cast<edge_weight_type>(get16(payload + 8)),
+                     static_cast<EdgeDirection>(payload[10]));
+}
+
+std::vector<uint8_t> edgeRecord(Node::integral_type src, Node::integral_type target, edge_weight_type weight, EdgeDirection direction)
+{
+    std::vector<uint8_t> payload;
+    payload.reserve(11);
+    put32(payload, src);
+    put32(payload, target);
+    put16(payload, static_cast<uint16_t>(weight));
+    payload.push_back(static_cast<uint8_t>(direction));
+    return payload;
+}
+
+}
+
+GraphJournal::GraphJournal(std::string const& path, JournalOptions options)
+    : m_path(path), m_options(options), m_fd(-1), m_kind(0), m_generation(0), m_journalBytes(0), m_snapshotBytes(0), m_recordsCount(0) { }
+
+GraphJournal::~GraphJournal()
+{
+    if (m_fd >= 0)
+    {
+        ::close(m_fd);
+    }
+}
+
+void GraphJournal::load(Graph& graph) noexcept(false)
+{
+    loadImpl(graph, graphKind);
+}
+
+void GraphJournal::load(LabeledGraph& graph) noexcept(false)
+{
+    loadImpl(graph, labeledGraphKind);
+}
+
+Edge GraphJournal::insertEdge(Graph& graph, Node::integral_type src, Node::integral_type target, edge_weight_type weight,
+                              EdgeDirection direction) noexcept(false)
+{
+    Edge edge = graph.insertEdge(src, target, weight, direction);
+    append(graphKind, insertEdgeRecord, edgeRecord(src, target, weight, direction));
+    if (shouldCompact())
+    {
+        compactImpl(graph, graphKind);
+    }
+    return edge;
+}
+
+Edge GraphJournal::insertEdge(LabeledGraph& graph, Node::integral_type src, Node::integral_type target, edge_weight_type weight,
+                              EdgeDirection direction) noexcept(false)
+{
+    Edge edge = graph.insertEdge(src, target, weight, direction);
+    append(labeledGraphKind, insertEdgeRecord, edgeRecord(src, target, weight, direction));
+    if (shouldCompact())
+    {
+        compactImpl(graph, labeledGraphKind);
+    }
+    return edge;
+}
+
+void GraphJournal::setLabel(LabeledGraph& graph, Node::integral_type node, std::string const& label) noexcept(false)
+{
+    if (!graph.contains(node))
+    {
+        throw std::invalid_argument("Node does not exist");
+    }
+    graph.setLabel(node, label);
+    std::vector<uint8_t> payload;
+    payload.reserve(4 + label.size());
+    put32(payload, node);
+    payload.insert(payload.end(), label.begin(), label.end());
+    append(labeledGraphKind, setLabelRecord, payload);
+    if (shouldCompact())
+    {
+        compactImpl(graph, labeledGraphKind);
+    }
+}
+
+void GraphJournal::compact(Graph const& graph) noexcept(false)
+{
+    compactImpl(graph, graphKind);
+}
+
+void GraphJournal::compact(LabeledGraph const& graph) noexcept(false)
+{
+    compactImpl(graph, labeledGraphKind);
+}
+
+void GraphJournal::sync() noexcept(false)
+{
+    if (m_fd >= 0)
+    {
+        FileIo::syncFile(m_fd, m_path + ".journal");
+    }
+}
+
+uint64_t GraphJournal::getGeneration() const noexcept
+{
+    return m_generation;
+}
+
+uint64_t GraphJournal::getJournalBytes() const noexcept
+{
+    return m_journalBytes;
+}
+
+uint64_t GraphJournal::getRecordsCount() const noexcept
+{
+    return m_recordsCount;
+}
+
+// =====================================================
+//                   IMPLEMENTATION
+// =====================================================
+
+// Record layout: uint32 payload size, uint8 type, payload, uint32 CRC-32 of type and payload.
+void GraphJournal::append(uint8_t kind, uint8_t type, std::vector<uint8_t> const& payload)
+{
+    if (m_fd < 0)
+    {
+        throw std::logic_error("The journal is not open; call load() or compact() first");
+    }
+    else if (kind != m_kind)
+    {
+        throw std::logic_error("The journal belongs to a different kind of graph");
+    }
+    std::vector<uint8_t> record;
+    record.reserve(payload.size() + 9);
+    put32(record, static_cast<uint32_t>(payload.size()));
+    record.push_back(type);
+    record.insert(record.end(), payload.begin(), payload.end());
+    put32(record, crc32(record.data() + 4, record.size() - 4));
+    FileIo::writeAll(m_fd, record.data(), record.size(), m_path + ".journal");
+    if (m_options.syncEveryRecord)
+    {
+        FileIo::syncFile(m_fd, m_path + ".journal");
+    }
+    m_journalBytes += record.size();
+    ++m_recordsCount;
+}
+
+void GraphJournal::startJournal(uint64_t generation)
+{
+    std::vector<uint8_t> header{'G', 'J', 'N', 'L'};
+    put32(header, formatVersion);
+    header.push_back(m_kind);
+    put64(header, generation);
+    put32(header, crc32(header.data(), header.size()));
+
+    if (m_fd >= 0)
+    {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+    std::string journal = m_path + ".journal";
+    replaceFile(journal, header);
+    m_fd = ::open(journal.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+    if (m_fd < 0)
+    {
+        throw FileIo::error("Could not open", journal);
+    }
+    m_generation = generation;
+    m_journalBytes = header.size();
+    m_recordsCount = 0;
+}
+
+bool GraphJournal::shouldCompact() const noexcept
+{
+    return m_options.compactionRatio > 0 && m_journalBytes > minimumCompactionBytes
+            && static_cast<double>(m_journalBytes) > m_options.compactionRatio * static_cast<double>(m_snapshotBytes);
+}
+
+template <typename GraphType>
+void GraphJournal::loadImpl(GraphType& graph, uint8_t kind)
+{
+    if (m_fd >= 0)
+    {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+    m_kind = kind;
+
+    // Snapshot layout: "GSNP", uint32 format version, uint8 kind, uint64 generation, uint64 size, XML, uint32 CRC-32.
+    std::vector<uint8_t> contents;
+    uint64_t generation = 0;
+    m_snapshotBytes = 0;
+    if (FileIo::readFile(m_path + ".snapshot", contents))
+    {
+        if (contents.size() < 29 || std::memcmp(contents.data(), "GSNP", 4) != 0 || get32(contents.data() + 4) != formatVersion
+                || get64(contents.data() + 17) != contents.size() - 29
+                || get32(contents.data() + contents.size() - 4) != crc32(contents.data(), contents.size() - 4))
+        {
+            throw std::runtime_error("Corrupted snapshot " + m_path + ".snapshot");
+        }
+        else if (contents[8] != kind)
+        {
+            throw std::runtime_error("The snapshot holds a different kind of graph");
+        }
+        generation = get64(contents.data() + 9);
+        graph.fromXml(std::string(reinterpret_cast<char const*>(contents.data() + 25), contents.size() - 29));
+        m_snapshotBytes = contents.size();
+    }
+
+    std::string journal = m_path + ".journal";
+    bool valid = FileIo::readFile(journal, contents) && contents.size() >= journalHeaderSize && std::memcmp(contents.data(), "GJNL", 4) == 0
+            && get32(contents.data() + 4) == formatVersion && get32(contents.data() + 17) == crc32(contents.data(), 17);
+    if (valid && contents[8] != kind)
+    {
+        throw std::runtime_error("The journal holds a different kind of graph");
+    }
+    else if (!valid || get64(contents.data() + 9) != generation)
+    {
+        // Missing, unreadable or left over from before the current snapshot.
+        startJournal(generation);
+        return;
+    }
+
+    std::size_t offset = journalHeaderSize;
+    uint64_t records = 0;
+    while (contents.size() - offset >= 9)
+    {
+        uint32_t size = get32(contents.data() + offset);
+        if (contents.size() - offset - 9 < size)
+        {
+            break;
+        }
+        uint8_t const* body = contents.data() + offset + 4;
+        if (get32(body + 1 + size) != crc32(body, 1 + size))
+        {
+            break;
+        }
+        applyRecord(graph, body[0], body + 1, size);
+        offset += 9 + size;
+        ++records;
+    }
+
+    m_fd = ::open(journal.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+    if (m_fd < 0)
+    {
+        throw FileIo::error("Could not open", journal);
+    }
+    if (offset != contents.size())
+    {
+        // A record torn by a crash: drop it so that new records follow the last complete one.
+        if (::ftruncate(m_fd, static_cast<off_t>(offset)) != 0)
+        {
+            throw FileIo::error("Could not truncate", journal);
+        }
+        FileIo::syncFile(m_fd, journal);
+    }
+    m_generation = generation;
+    m_journalBytes = offset;
+    m_recordsCount = records;
+}
+
+template <typename GraphType>
+void GraphJournal::compactImpl(GraphType const& graph, uint8_t kind)
+{
+    std::string xml = graph.serialize();
+    std::vector<uint8_t> snapshot{'G', 'S', 'N', 'P'};
+    snapshot.reserve(xml.size() + 29);
+    put32(snapshot, formatVersion);
+    snapshot.push_back(kind);
+    put64(snapshot, m_generation + 1);
+    put64(snapshot, xml.size());
+    snapshot.insert(snapshot.end(), xml.begin(), xml.end());
+    put32(snapshot, crc32(snapshot.data(), snapshot.size()));
+    replaceFile(m_path + ".snapshot", snapshot);
+
+    // A crash from here on leaves a journal of the previous generation, which load() discards.
+    m_kind = kind;
+    m_snapshotBytes = snapshot.size();
+    startJournal(m_generation + 1);
+}
+
+}
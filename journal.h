@@ -0,0 +1,83 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <string>
+#include <vector>
+#include "commontypes.hpp"
+
+namespace Graphs
+{
+
+// Forward declaration of Graph class
+class Graph;
+// Forward declaration of LabeledGraph class
+class LabeledGraph;
+
+struct JournalOptions
+{
+    // fdatasync() after every record instead of only in sync() and compact().
+    bool syncEveryRecord = false;
+    // A mutation compacts automatically once the journal outgrows this multiple of the snapshot; 0 disables.
+    double compactionRatio = 1.0;
+};
+
+// Incremental persistence for a Graph or LabeledGraph, kept in two files next to `path`:
+//   path.snapshot  full serialize() output of some generation, checksummed
+//   path.journal   mutations applied since that generation, one checksummed binary record each
+// Mutations made through the journal are applied to the graph and appended to the journal, so saving
+// a change costs I/O proportional to the change. compact() writes a new snapshot and starts an empty
+// journal; both files are replaced by rename, so a crash leaves either the old or the new pair valid.
+// A journal whose generation does not match the snapshot is left over from an interrupted compaction
+// and is discarded, and a torn record at the end of the journal is cut off on load.
+class GraphJournal
+{
+private:
+    std::string m_path;
+    JournalOptions m_options;
+    int m_fd;
+    uint8_t m_kind;
+    uint64_t m_generation;
+    uint64_t m_journalBytes;
+    uint64_t m_snapshotBytes;
+    uint64_t m_recordsCount;
+
+    void append(uint8_t kind, uint8_t type, std::vector<uint8_t> const& payload);
+    void startJournal(uint64_t generation);
+    bool shouldCompact() const noexcept;
+    template <typename GraphType>
+    void loadImpl(GraphType& graph, uint8_t kind);
+    template <typename GraphType>
+    void compactImpl(GraphType const& graph, uint8_t kind);
+
+public:
+    explicit GraphJournal(std::string const& path, JournalOptions options = JournalOptions{});
+    GraphJournal(GraphJournal const&) = delete;
+    GraphJournal(GraphJournal&&) = delete;
+    GraphJournal& operator=(GraphJournal const&) = delete;
+    GraphJournal& operator=(GraphJournal&&) = delete;
+    ~GraphJournal();
+
+    // Rebuilds `graph` from the snapshot, if any, and replays the journal on top of it. Without a
+    // snapshot the journal is replayed onto `graph` as given. Opens the journal for appending.
+    void load(Graph& graph) noexcept(false);
+    void load(LabeledGraph& graph) noexcept(false);
+
+    Edge insertEdge(Graph& graph, Node::integral_type src, Node::integral_type target, edge_weight_type weight,
+                    EdgeDirection direction = EdgeDirection::Undirected) noexcept(false);
+    Edge insertEdge(LabeledGraph& graph, Node::integral_type src, Node::integral_type target, edge_weight_type weight,
+                    EdgeDirection direction = EdgeDirection::Undirected) noexcept(false);
+    void setLabel(LabeledGraph& graph, Node::integral_type node, std::string const& label) noexcept(false);
+
+    void compact(Graph const& graph) noexcept(false);
+    void compact(LabeledGraph const& graph) noexcept(false);
+    // Makes every appended record durable.
+    void sync() noexcept(false);
+
+    uint64_t getGeneration() const noexcept;
+    uint64_t getJournalBytes() const noexcept;
+    uint64_t getRecordsCount() const noexcept;
+};
+
+}
+
+#endif // JOURNAL_H
@@ -0,0 +1,168 @@
+#include "kcore.h"
+#include "adjacencylist.h"
+#include "graph.h"
+#include "labeledgraph.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <stdexcept>
+
+namespace Graphs
+{
+
+namespace Algorithms
+{
+
+static DegreeStatistics degreeStatisticsImpl(Graph const& graph, DegreeKind kind) noexcept(false);
+static CoreDecomposition coreDecompositionImpl(Graph const& graph, unsigned threads) noexcept(false);
+
+DegreeStatistics degreeStatistics(Graph const& graph, DegreeKind kind) noexcept(false)
+{
+    return degreeStatisticsImpl(graph, kind);
+}
+
+DegreeStatistics degreeStatistics(LabeledGraph const& graph, DegreeKind kind) noexcept(false)
+{
+    return degreeStatisticsImpl(graph.getRawGraph(), kind);
+}
+
+CoreDecomposition coreDecomposition(Graph const& graph, unsigned threads) noexcept(false)
+{
+    return coreDecompositionImpl(graph, threads);
+}
+
+CoreDecomposition coreDecomposition(LabeledGraph const& graph, unsigned threads) noexcept(false)
+{
+    return coreDecompositionImpl(graph.getRawGraph(), threads);
+}
+
+// =====================================================
+//                   IMPLEMENTATION
+// =====================================================
+
+DegreeStatistics degreeStatisticsImpl(Graph const& graph, DegreeKind kind) noexcept(false)
+{
+    if (graph.getSize() == 0)
+    {
+        throw std::invalid_argument("The graph has no nodes");
+    }
+    std::vector<uint32_t> const& out = graph.getOutDegrees();
+    std::vector<uint32_t> const& in = graph.getInDegrees();
+    DegreeStatistics statistics{std::numeric_limits<uint32_t>::max(), 0, 0.0, {}};
+    uint64_t sum = 0;
+    for (Node::integral_type node = 0; node < graph.getSize(); ++node)
+    {
+        uint32_t degree = kind == DegreeKind::Out ? out[node] : (kind == DegreeKind::In ? in[node] : out[node] + in[node]);
+        statistics.minimum = std::min(statistics.minimum, degree);
+        statistics.maximum = std::max(statistics.maximum, degree);
+        if (degree >= statistics.histogram.size())
+        {
+            statistics.histogram.resize(degree + 1, 0);
+        }
+        ++statistics.histogram[degree];
+        sum += degree;
+    }
+    statistics.mean = static_cast<double>(sum) / graph.getSize();
+    return statistics;
+}
+
+CoreDecomposition coreDecompositionImpl(Graph const& graph, unsigned threads) noexcept(false)
+{
+    AdjacencyList undirected = AdjacencyList{graph}.symmetrized();
+    uint32_t size = undirected.getSize();
+    unsigned workers = Parallel::threadsCount(threads);
+    constexpr std::size_t chunk = 256;
+
+    std::unique_ptr<std::atomic<uint32_t>[]> degrees(new std::atomic<uint32_t>[size]);
+    for (Node::integral_type node = 0; node < size; ++node)
+    {
+        degrees[node].store(undirected.getDegree(node), std::memory_order_relaxed);
+    }
+    CoreDecomposition decomposition{std::vector<uint32_t>(size, 0), {}, 0};
+    decomposition.degeneracyOrder.reserve(size);
+    std::vector<uint8_t> removed(size, 0);
+    std::vector<Node::integral_type> alive(size);
+    for (Node::integral_type node = 0; node < size; ++node)
+    {
+        alive[node] = node;
+    }
+    std::vector<std::vector<Node::integral_type>> found(workers);
+    std::vector<std::vector<Node::integral_type>> kept(workers);
+    std::vector<uint32_t> minimums(workers);
+    std::vector<Node::integral_type> frontier;
+
+    auto gather = [](std::vector<std::vector<Node::integral_type>>& parts, std::vector<Node::integral_type>& into)
+    {
+        into.clear();
+        for (auto&& part : parts)
+        {
+            into.insert(into.end(), part.begin(), part.end());
+            part.clear();
+        }
+    };
+
+    uint32_t level = 0;
+    while (!alive.empty())
+    {
+        // Degrees only fall, so the next non-empty level is the smallest remaining degree.
+        std::fill(minimums.begin(), minimums.end(), std::numeric_limits<uint32_t>::max());
+        Parallel::forEach(alive.size(), workers, [&](unsigned worker, std::size_t index)
+        {
+            minimums[worker] = std::min(minimums[worker], degrees[alive[index]].load(std::memory_order_relaxed));
+        }, chunk);
+        level = std::max(level, *std::min_element(minimums.begin(), minimums.end()));
+
+        Parallel::forEach(alive.size(), workers, [&](unsigned worker, std::size_t index)
+        {
+            Node::integral_type node = alive[index];
+            (degrees[node].load(std::memory_order_relaxed) <= level ? found : kept)[worker].push_back(node);
+        }, chunk);
+        gather(found, frontier);
+        gather(kept, alive);
+
+        while (!frontier.empty())
+        {
+            std::sort(frontier.begin(), frontier.end());
+            for (Node::integral_type node : frontier)
+            {
+                removed[node] = 1;
+                decomposition.coreness[node] = level;
+                decomposition.degeneracyOrder.push_back(node);
+            }
+            Parallel::forEach(frontier.size(), workers, [&](unsigned worker, std::size_t index)
+            {
+                Node::integral_type node = frontier[index];
+                for (auto it = undirected.targetsBegin(node); it != undirected.targetsEnd(node); ++it)
+                {
+                    // Nodes at or below the level are peeled already or about to be; their degree is left alone.
+                    uint32_t current = degrees[*it].load(std::memory_order_relaxed);
+                    while (current > level && !degrees[*it].compare_exchange_weak(current, current - 1, std::memory_order_relaxed))
+                    {
+                    }
+                    if (current == level + 1)
+                    {
+                        found[worker].push_back(*it);
+                    }
+                }
+            }, chunk);
+            gather(found, frontier);
+        }
+        if (!alive.empty())
+        {
+            // Drop the nodes peeled in the sub-rounds from the candidates of the next level.
+            alive.erase(std::remove_if(alive.begin(), alive.end(), [&removed](Node::integral_type node) { return removed[node] != 0; }),
+                        alive.end());
+        }
+    }
+    decomposition.degeneracy = level;
+    return decomposition;
+}
+
+}
+
+}
@@ -0,0 +1,59 @@
+#ifndef KCORE_H
+#define KCORE_H
+
+#include <vector>
+#include "commontypes.hpp"
+
+namespace Graphs
+{
+
+// Forward declaration of Graph class
+class Graph;
+// Forward declaration of LabeledGraph class
+class LabeledGraph;
+
+namespace Algorithms
+{
+
+enum class DegreeKind : uint8_t
+{
+    Out,
+    In,
+    // Out plus in; an undirected edge counts twice.
+    Total
+};
+
+struct DegreeStatistics
+{
+    uint32_t minimum;
+    uint32_t maximum;
+    double mean;
+    // Number of nodes of each degree, up to the maximum.
+    std::vector<uint64_t> histogram;
+};
+
+struct CoreDecomposition
+{
+    // Largest k such that the node belongs to the k-core.
+    std::vector<uint32_t> coreness;
+    // Nodes in the order they were peeled; each has at most `degeneracy` neighbours after it.
+    std::vector<Node::integral_type> degeneracyOrder;
+    uint32_t degeneracy;
+};
+
+// Read from the degree arrays the graph maintains, in O(V).
+DegreeStatistics degreeStatistics(Graph const& graph, DegreeKind kind = DegreeKind::Out) noexcept(false);
+DegreeStatistics degreeStatistics(LabeledGraph const& graph, DegreeKind kind = DegreeKind::Out) noexcept(false);
+
+// Parallel bucket peeling over the graph with directions ignored and self loops dropped. Level k repeatedly
+// removes every remaining node of degree at most k, in sub-rounds whose neighbour updates run concurrently
+// with atomic decrements that stop at k; empty levels are skipped. Nodes peeled in one sub-round enter the
+// degeneracy order by id, so the result does not depend on the number of threads.
+CoreDecomposition coreDecomposition(Graph const& graph, unsigned threads = 0) noexcept(false);
+CoreDecomposition coreDecomposition(LabeledGraph const& graph, unsigned threads = 0) noexcept(false);
+
+}
+
+}
+
+#endif // KCORE_H
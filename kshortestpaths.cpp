@@ -0,0 +1,396 @@
+#include "kshortestpaths.h"
+#include "adjacencylist.h"
+#include "graph.h"
+#include "labeledgraph.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <stdexcept>
+
+namespace Graphs
+{
+
+namespace Algorithms
+{
+
+static std::vector<WeightedPath> kShortestPathsImpl(Graph const& graph, Node const& root, Node const& target, uint32_t k) noexcept(false);
+static std::vector<WeightedPath> alternativeRoutesImpl(Graph const& graph, Node const& root, Node const& target, uint32_t k,
+                                                       AlternativeRoutesOptions const& options) noexcept(false);
+
+std::vector<WeightedPath> kShortestPaths(Graph const& graph, Node const& root, Node const& target, uint32_t k) noexcept(false)
+{
+    return kShortestPathsImpl(graph, root, target, k);
+}
+
+std::vector<WeightedPath> kShortestPaths(LabeledGraph const& graph, LabeledNode const& root, LabeledNode const& target, uint32_t k) noexcept(false)
+{
+    return kShortestPathsImpl(graph.getRawGraph(), root.node, target.node, k);
+}
+
+std::vector<WeightedPath> kShortestPaths(LabeledGraph const& graph, std::string const& root, std::string const& target, uint32_t k) noexcept(false)
+{
+    return kShortestPathsImpl(graph.getRawGraph(), graph.getNode(root).node, graph.getNode(target).node, k);
+}
+
+std::vector<WeightedPath> alternativeRoutes(Graph const& graph, Node const& root, Node const& target, uint32_t k,
+                                            AlternativeRoutesOptions const& options) noexcept(false)
+{
+    return alternativeRoutesImpl(graph, root, target, k, options);
+}
+
+std::vector<WeightedPath> alternativeRoutes(LabeledGraph const& graph, LabeledNode const& root, LabeledNode const& target, uint32_t k,
+                                            AlternativeRoutesOptions const& options) noexcept(false)
+{
+    return alternativeRoutesImpl(graph.getRawGraph(), root.node, target.node, k, options);
+}
+
+std::vector<WeightedPath> alternativeRoutes(LabeledGraph const& graph, std::string const& root, std::string const& target, uint32_t k,
+                                            AlternativeRoutesOptions const& options) noexcept(false)
+{
+    return alternativeRoutesImpl(graph.getRawGraph(), graph.getNode(root).node, graph.getNode(target).node, k, options);
+}
+
+// =====================================================
+//                   IMPLEMENTATION
+// =====================================================
+
+namespace
+{
+
+using node_type = Node::integral_type;
+constexpr node_type noParent = std::numeric_limits<node_type>::max();
+
+// Plain Dijkstra from `root` over `adjacency`, filling distances and the tree parent of every reached node.
+// On a transposed adjacency the parents are the next hops towards `root`.
+void shortestPathTree(AdjacencyList const& adjacency, node_type root, std::vector<int64_t>& distances, std::vector<node_type>& parents)
+{
+    using entry_type = std::pair<int64_t, node_type>;
+    distances.assign(adjacency.getSize(), unreachableDistance);
+    parents.assign(adjacency.getSize(), noParent);
+    std::vector<entry_type> heap;
+    distances[root] = 0;
+    heap.push_back(entry_type{0, root});
+    while (!heap.empty())
+    {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<entry_type>());
+        entry_type top = heap.back();
+        heap.pop_back();
+        if (top.first != distances[top.second])
+        {
+            continue;
+        }
+        edge_weight_type const* weight = adjacency.weightsBegin(top.second);
+        for (auto it = adjacency.targetsBegin(top.second); it != adjacency.targetsEnd(top.second); ++it, ++weight)
+        {
+            int64_t candidate = top.first + *weight;
+            if (candidate < distances[*it])
+            {
+                distances[*it] = candidate;
+                parents[*it] = top.second;
+                heap.push_back(entry_type{candidate, *it});
+                std::push_heap(heap.begin(), heap.end(), std::greater<entry_type>());
+            }
+        }
+    }
+}
+
+int64_t edgeWeight(AdjacencyList const& adjacency, node_type source, node_type target)
+{
+    auto found = std::lower_bound(adjacency.targetsBegin(source), adjacency.targetsEnd(source), target);
+    return adjacency.weightsBegin(source)[found - adjacency.targetsBegin(source)];
+}
+
+// Scratch state of the spur searches. Every array is valid only where its stamp matches the current
+// search or block, so starting a new one costs nothing regardless of the graph size.
+class SpurSearch
+{
+private:
+    struct Entry
+    {
+        int64_t estimate;
+        int64_t distance;
+        node_type node;
+
+        bool operator>(Entry const& other) const noexcept
+        {
+            return estimate > other.estimate || (estimate == other.estimate && distance < other.distance);
+        }
+    };
+
+    AdjacencyList const& m_adjacency;
+    std::vector<int64_t> const& m_toTarget;
+    std::vector<int64_t> m_distances;
+    std::vector<node_type> m_parents;
+    std::vector<uint32_t> m_searchStamps;
+    std::vector<uint32_t> m_blockStamps;
+    std::vector<Entry> m_heap;
+    uint32_t m_search;
+    uint32_t m_block;
+
+public:
+    SpurSearch(AdjacencyList const& adjacency, std::vector<int64_t> const& toTarget)
+        : m_adjacency{adjacency}, m_toTarget{toTarget}, m_distances(adjacency.getSize()), m_parents(adjacency.getSize()),
+          m_searchStamps(adjacency.getSize(), 0), m_blockStamps(adjacency.getSize(), 0), m_search{0}, m_block{0}
+    {
+    }
+
+    // Unblocks every node.
+    void startBlock() noexcept
+    {
+        ++m_block;
+    }
+
+    void blockNode(node_type node) noexcept
+    {
+        m_blockStamps[node] = m_block;
+    }
+
+    // A* from `spur` to `target` avoiding blocked nodes and the spur edges towards `removed`. The reverse
+    // tree distances are exact in the full graph and can only grow once nodes and edges are taken away,
+    // so they form a consistent potential. Appends the path after `spur` to `path` and returns its cost.
+    int64_t run(node_type spur, node_type target, std::vector<node_type> const& removed, std::vector<node_type>& path)
+    {
+        ++m_search;
+        m_heap.clear();
+        m_searchStamps[spur] = m_search;
+        m_distances[spur] = 0;
+        m_parents[spur] = noParent;
+        m_heap.push_back(Entry{m_toTarget[spur], 0, spur});
+        while (!m_heap.empty())
+        {
+            std::pop_heap(m_heap.begin(), m_heap.end(), std::greater<Entry>());
+            Entry top = m_heap.back();
+            m_heap.pop_back();
+            if (top.distance != m_distances[top.node])
+            {
+                continue;
+            }
+            if (top.node == target)
+            {
+                std::size_t first = path.size();
+                for (node_type node = target; node != spur; node = m_parents[node])
+                {
+                    path.push_back(node);
+                }
+                std::reverse(path.begin() + static_cast<std::ptrdiff_t>(first), path.end());
+                return top.distance;
+            }
+            edge_weight_type const* weight = m_adjacency.weightsBegin(top.node);
+            for (auto it = m_adjacency.targetsBegin(top.node); it != m_adjacency.targetsEnd(top.node); ++it, ++weight)
+            {
+                node_type next = *it;
+                if (m_blockStamps[next] == m_block || m_toTarget[next] == unreachableDistance
+                        || (top.node == spur && std::find(removed.begin(), removed.end(), next) != removed.end()))
+                {
+                    continue;
+                }
+                int64_t candidate = top.distance + *weight;
+                if (m_searchStamps[next] != m_search || candidate < m_distances[next])
+                {
+                    m_searchStamps[next] = m_search;
+                    m_distances[next] = candidate;
+                    m_parents[next] = top.node;
+                    m_heap.push_back(Entry{candidate + m_toTarget[next], candidate, next});
+                    std::push_heap(m_heap.begin(), m_heap.end(), std::greater<Entry>());
+                }
+            }
+        }
+        return unreachableDistance;
+    }
+};
+
+void checkEndpoints(Graph const& graph, Node const& root, Node const& target, AdjacencyList const& adjacency)
+{
+    if (!graph.contains(root) || !graph.contains(target))
+    {
+        throw std::invalid_argument("Root or target node does not exist in the graph");
+    }
+    else if (adjacency.getMinWeight() < 0)
+    {
+        throw std::invalid_argument("Shortest paths require non-negative edge weights");
+    }
+}
+
+}
+
+std::vector<WeightedPath> kShortestPathsImpl(Graph const& graph, Node const& root, Node const& target, uint32_t k) noexcept(false)
+{
+    AdjacencyList adjacency{graph};
+    checkEndpoints(graph, root, target, adjacency);
+    std::vector<WeightedPath> paths;
+    std::vector<int64_t> toTarget;
+    std::vector<node_type> nextHops;
+    shortestPathTree(adjacency.transposed(), target.id, toTarget, nextHops);
+    if (k == 0 || toTarget[root.id] == unreachableDistance)
+    {
+        return paths;
+    }
+
+    WeightedPath shortest{{root.id}, toTarget[root.id]};
+    for (node_type node = root.id; node != target.id; node = nextHops[node])
+    {
+        shortest.nodes.push_back(nextHops[node]);
+    }
+    paths.push_back(std::move(shortest));
+
+    // Candidates ordered by cost, then by node sequence; equal paths collapse into one entry.
+    std::set<std::pair<int64_t, std::vector<node_type>>> candidates;
+    SpurSearch search{adjacency, toTarget};
+    std::vector<node_type> removed;
+    std::vector<node_type> path;
+    while (paths.size() < k)
+    {
+        std::vector<node_type> const& previous = paths.back().nodes;
+        search.startBlock();
+        int64_t rootCost = 0;
+        for (std::size_t index = 0; index + 1 < previous.size(); ++index)
+        {
+            node_type spur = previous[index];
+            if (index > 0)
+            {
+                // The root path grows by one node per spur; its nodes stay blocked for the later spurs.
+                search.blockNode(previous[index - 1]);
+                rootCost += edgeWeight(adjacency, previous[index - 1], spur);
+            }
+            // Edges leaving the spur along accepted paths that share its root path.
+            removed.clear();
+            for (auto&& accepted : paths)
+            {
+                if (accepted.nodes.size() > index + 1 && std::equal(previous.begin(), previous.begin() + static_cast<std::ptrdiff_t>(index) + 1,
+                                                                     accepted.nodes.begin()))
+                {
+                    removed.push_back(accepted.nodes[index + 1]);
+                }
+            }
+
+            path.assign(previous.begin(), previous.begin() + static_cast<std::ptrdiff_t>(index) + 1);
+            int64_t spurCost = search.run(spur, target.id, removed, path);
+            if (spurCost != unreachableDistance)
+            {
+                candidates.emplace(rootCost + spurCost, path);
+            }
+        }
+        if (candidates.empty())
+        {
+            break;
+        }
+        auto best = candidates.begin();
+        paths.push_back(WeightedPath{best->second, best->first});
+        candidates.erase(best);
+    }
+    return paths;
+}
+
+std::vector<WeightedPath> alternativeRoutesImpl(Graph const& graph, Node const& root, Node const& target, uint32_t k,
+                                                AlternativeRoutesOptions const& options) noexcept(false)
+{
+    AdjacencyList adjacency{graph};
+    checkEndpoints(graph, root, target, adjacency);
+    if (options.maxStretch < 1.0 || options.maxOverlap < 0.0)
+    {
+        throw std::invalid_argument("Stretch must be at least 1 and overlap must not be negative");
+    }
+    std::vector<WeightedPath> routes;
+    std::vector<int64_t> fromRoot;
+    std::vector<node_type> parents;
+    std::vector<int64_t> toTarget;
+    std::vector<node_type> nextHops;
+    shortestPathTree(adjacency, root.id, fromRoot, parents);
+    if (k == 0 || fromRoot[target.id] == unreachableDistance)
+    {
+        return routes;
+    }
+    shortestPathTree(adjacency.transposed(), target.id, toTarget, nextHops);
+
+    int64_t limit = static_cast<int64_t>(static_cast<double>(fromRoot[target.id]) * options.maxStretch);
+    std::vector<std::pair<int64_t, node_type>> vias;
+    for (node_type node = 0; node < adjacency.getSize(); ++node)
+    {
+        if (fromRoot[node] != unreachableDistance && toTarget[node] != unreachableDistance && fromRoot[node] + toTarget[node] <= limit)
+        {
+            vias.emplace_back(fromRoot[node] + toTarget[node], node);
+        }
+    }
+    std::sort(vias.begin(), vias.end());
+
+    // Routes using each edge, keyed by source and target.
+    std::unordered_map<uint64_t, std::vector<uint32_t>> used;
+    std::vector<uint32_t> onPath(adjacency.getSize(), 0);
+    // Every via node on an accepted route rebuilds that same route; with zero-cost edges or maxOverlap >= 1
+    // the overlap test alone would let those copies through.
+    std::set<std::vector<node_type>> accepted;
+    std::vector<int64_t> shared;
+    std::vector<node_type> nodes;
+    uint32_t stamp = 0;
+    for (auto&& via : vias)
+    {
+        if (routes.size() == k)
+        {
+            break;
+        }
+        nodes.clear();
+        for (node_type node = via.second; node != noParent; node = parents[node])
+        {
+            nodes.push_back(node);
+        }
+        std::reverse(nodes.begin(), nodes.end());
+        for (node_type node = via.second; node != target.id; node = nextHops[node])
+        {
+            nodes.push_back(nextHops[node]);
+        }
+
+        // Loopless: the root and target halves must not meet before the via node.
+        ++stamp;
+        bool simple = true;
+        for (node_type node : nodes)
+        {
+            if (onPath[node] == stamp)
+            {
+                simple = false;
+                break;
+            }
+            onPath[node] = stamp;
+        }
+        if (!simple || accepted.count(nodes) != 0)
+        {
+            continue;
+        }
+
+        shared.assign(routes.size(), 0);
+        for (std::size_t index = 0; index + 1 < nodes.size(); ++index)
+        {
+            auto found = used.find((uint64_t{nodes[index]} << 32) | nodes[index + 1]);
+            if (found != used.end())
+            {
+                int64_t weight = edgeWeight(adjacency, nodes[index], nodes[index + 1]);
+                for (uint32_t route : found->second)
+                {
+                    shared[route] += weight;
+                }
+            }
+        }
+        double cost = static_cast<double>(via.first);
+        if (std::any_of(shared.begin(), shared.end(), [&](int64_t overlap) { return static_cast<double>(overlap) > options.maxOverlap * cost; }))
+        {
+            continue;
+        }
+
+        for (std::size_t index = 0; index + 1 < nodes.size(); ++index)
+        {
+            used[(uint64_t{nodes[index]} << 32) | nodes[index + 1]].push_back(static_cast<uint32_t>(routes.size()));
+        }
+        accepted.insert(nodes);
+        routes.push_back(WeightedPath{nodes, via.first});
+    }
+    return routes;
+}
+
+}
+
+}
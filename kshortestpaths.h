@@ -0,0 +1,55 @@
+#ifndef KSHORTESTPATHS_H
+#define KSHORTESTPATHS_H
+
+#include <vector>
+#include "commontypes.hpp"
+
+namespace Graphs
+{
+
+// Forward declaration of Graph class
+class Graph;
+// Forward declaration of LabeledGraph class
+class LabeledGraph;
+
+namespace Algorithms
+{
+
+struct WeightedPath
+{
+    std::vector<Node::integral_type> nodes;
+    int64_t cost;
+};
+
+struct AlternativeRoutesOptions
+{
+    // Routes may cost at most this multiple of the shortest one.
+    double maxStretch = 1.25;
+    // Largest share of a route's cost that may run along edges of any route accepted before it.
+    double maxOverlap = 0.5;
+};
+
+// Yen's k shortest loopless paths over non-negative weights, cheapest first; fewer are returned when the
+// graph has fewer simple paths from root to target. One reverse shortest-path tree towards the target is
+// computed up front and serves every spur search as an exact A* potential: a spur search whose tree path
+// is still usable walks straight down it, and the others only explore around the removed part.
+std::vector<WeightedPath> kShortestPaths(Graph const& graph, Node const& root, Node const& target, uint32_t k) noexcept(false);
+std::vector<WeightedPath> kShortestPaths(LabeledGraph const& graph, LabeledNode const& root, LabeledNode const& target, uint32_t k) noexcept(false);
+std::vector<WeightedPath> kShortestPaths(LabeledGraph const& graph, std::string const& root, std::string const& target, uint32_t k) noexcept(false);
+
+// Up to k routes built from one forward tree of the root and one reverse tree of the target: every node v
+// suggests the route root -> v -> target through both trees, and routes are accepted in order of cost when
+// they are loopless and within the stretch and overlap limits. Two searches in total, but not guaranteed
+// to find k routes even where Yen would.
+std::vector<WeightedPath> alternativeRoutes(Graph const& graph, Node const& root, Node const& target, uint32_t k,
+                                            AlternativeRoutesOptions const& options = AlternativeRoutesOptions{}) noexcept(false);
+std::vector<WeightedPath> alternativeRoutes(LabeledGraph const& graph, LabeledNode const& root, LabeledNode const& target, uint32_t k,
+                                            AlternativeRoutesOptions const& options = AlternativeRoutesOptions{}) noexcept(false);
+std::vector<WeightedPath> alternativeRoutes(LabeledGraph const& graph, std::string const& root, std::string const& target, uint32_t k,
+                                            AlternativeRoutesOptions const& options = AlternativeRoutesOptions{}) noexcept(false);
+
+}
+
+}
+
+#endif // KSHORTESTPATHS_H
@@ -1,4 +1,5 @@
 #include "labeledgraph.h"
+#include <limits>
 #include <stdexcept>
 #include <algorithm>
 
@@ -9,6 +10,15 @@ LabeledGraph::LabeledGraph() : m_graph{}, m_labels{} { }
 
 LabeledGraph::LabeledGraph(uint32_t size) : m_graph{size}, m_labels(size, "") { }
 
+LabeledGraph::LabeledGraph(Graph&& graph, std::vector<std::string>&& labels) noexcept(false)
+    : m_graph{std::move(graph)}, m_labels{std::move(labels)}
+{
+    if (m_labels.size() != m_graph.getSize())
+    {
+        throw std::invalid_argument("Every node needs exactly one label");
+    }
+}
+
 Graph const& LabeledGraph::getRawGraph() const noexcept
 {
     return m_graph;
@@ -19,6 +29,39 @@ uint32_t LabeledGraph::getSize() const noexcept
     return m_graph.getSize();
 }
 
+uint64_t LabeledGraph::getVersion() const noexcept
+{
+    return m_graph.getVersion();
+}
+
+GraphRepresentation LabeledGraph::getRepresentation() const noexcept
+{
+    return m_graph.getRepresentation();
+}
+
+void LabeledGraph::setRepresentation(GraphRepresentation representation) noexcept(false)
+{
+    m_graph.setRepresentation(representation);
+}
+
+void LabeledGraph::optimizeRepresentation()
+{
+    m_graph.optimizeRepresentation();
+}
+
+MemoryUsage LabeledGraph::memoryUsage() const noexcept
+{
+    MemoryUsage usage = m_graph.memoryUsage();
+    usage.indices += sizeof(LabeledGraph) - sizeof(Graph);
+    std::size_t inlineCapacity = std::string().capacity();
+    usage.labels += m_labels.capacity() * sizeof(std::string);
+    for (auto&& label : m_labels)
+    {
+        usage.labels += label.capacity() > inlineCapacity ? label.capacity() + 1 : 0;
+    }
+    return usage;
+}
+
 void LabeledGraph::setLabel(Node::integral_type node, std::string const& label) noexcept
 {
     m_labels[node] = label;
@@ -180,6 +223,45 @@ edge_weight_type LabeledGraph::getEdgeWeight(std::string const& src, std::string
     return getEdgeWeight(findNode(src), findNode(target));
 }
 
+LabeledSubgraph LabeledGraph::withLabels(Subgraph&& subgraph) const
+{
+    std::vector<std::string> labels;
+    labels.reserve(subgraph.localToGlobal.size());
+    for (auto&& node : subgraph.localToGlobal)
+    {
+        labels.push_back(m_labels[node]);
+    }
+    return LabeledSubgraph{LabeledGraph{std::move(subgraph.graph), std::move(labels)}, std::move(subgraph.localToGlobal)};
+}
+
+LabeledSubgraph LabeledGraph::extractInducedSubgraph(std::vector<Node::integral_type> const& nodes) const noexcept(false)
+{
+    return withLabels(m_graph.extractInducedSubgraph(nodes));
+}
+
+LabeledSubgraph LabeledGraph::extractEgoNetwork(Node::integral_type center, uint32_t hops) const noexcept(false)
+{
+    return withLabels(m_graph.extractEgoNetwork(center, hops));
+}
+
+LabeledSubgraph LabeledGraph::extractEgoNetwork(std::string const& center, uint32_t hops) const noexcept(false)
+{
+    return withLabels(m_graph.extractEgoNetwork(getNode(center).node.id, hops));
+}
+
+std::vector<LabeledSubgraph> LabeledGraph::extractEgoNetworks(std::vector<Node::integral_type> const& centers, uint32_t hops,
+                                                              unsigned threads) const noexcept(false)
+{
+    std::vector<Subgraph> subgraphs = m_graph.extractEgoNetworks(centers, hops, threads);
+    std::vector<LabeledSubgraph> labeled;
+    labeled.reserve(subgraphs.size());
+    for (auto&& subgraph : subgraphs)
+    {
+        labeled.push_back(withLabels(std::move(subgraph)));
+    }
+    return labeled;
+}
+
 std::string LabeledGraph::serialize() const
 {
     QString xml;
@@ -237,7 +319,7 @@ void LabeledGraph::fromXml(std::string const& xml)
                     if (attribute.name().toString() == "size")
                     {
                         uint32_t size = attribute.value().toUInt();
-                        m_graph = Graph{size};
+                        m_graph = Graph{size, GraphRepresentation::Sparse};
                         m_labels = std::vector<std::string>(size, "");
                     }
                 }
@@ -284,10 +366,18 @@ void LabeledGraph::fromXml(std::string const& xml)
                                 }
                                 else if (attrName == "weight")
                                 {
-                                    weight = attribute.value().toUInt();
+                                    // Signed, so negative weights survive a serialize() round trip.
+                                    bool parsed = false;
+                                    int value = attribute.value().toInt(&parsed);
+                                    if (!parsed || value <= std::numeric_limits<edge_weight_type>::min()
+                                        || value > std::numeric_limits<edge_weight_type>::max())
+                                    {
+                                        throw std::runtime_error("Edge weight is not a valid 16-bit weight");
+                                    }
+                                    weight = static_cast<edge_weight_type>(value);
                                 }
                             }
-                            m_graph.insertEdge(src.id, sink.id, weight);
+                            m_graph.insertEdge(src.id, sink.id, weight, EdgeDirection::Directed);
                         }
                         xmlReader.readNext();
                     }
@@ -308,6 +398,7 @@ void LabeledGraph::fromXml(std::string const& xml)
     {
         throw std::runtime_error(xmlReader.errorString().toStdString());
     }
+    m_graph.optimizeRepresentation();
 }
 
 }
@@ -7,6 +7,8 @@
 namespace Graphs
 {
 
+struct LabeledSubgraph;
+
 class LabeledGraph : public IXmlSerializable
 {
 private:
@@ -16,6 +18,8 @@ private:
 public:
     LabeledGraph();
     LabeledGraph(uint32_t size);
+    // Takes over an existing graph with one label per node.
+    LabeledGraph(Graph&& graph, std::vector<std::string>&& labels) noexcept(false);
     LabeledGraph(LabeledGraph const&) = default;
     LabeledGraph(LabeledGraph&&) = default;
     LabeledGraph& operator=(LabeledGraph const&) = default;
@@ -25,6 +29,13 @@ public:
     Graph const& getRawGraph() const noexcept;
 
     uint32_t getSize() const noexcept;
+    uint64_t getVersion() const noexcept;
+
+    GraphRepresentation getRepresentation() const noexcept;
+    void setRepresentation(GraphRepresentation representation) noexcept(false);
+    void optimizeRepresentation();
+    // Graph storage plus the labels; short labels living inside std::string itself cost no extra heap.
+    MemoryUsage memoryUsage() const noexcept;
 
     void setLabel(Node::integral_type node, std::string const& label) noexcept;
     void setLabel(LabeledNode node, std::string&& label) noexcept;
@@ -61,11 +72,26 @@ public:
     edge_weight_type getEdgeWeight(LabeledNode const& src, LabeledNode const& target) const noexcept(false);
     edge_weight_type getEdgeWeight(std::string const& src, std::string const& target) const noexcept(false);
 
+    // Same as the Graph extractions, with every node keeping its label.
+    LabeledSubgraph extractInducedSubgraph(std::vector<Node::integral_type> const& nodes) const noexcept(false);
+    LabeledSubgraph extractEgoNetwork(Node::integral_type center, uint32_t hops) const noexcept(false);
+    LabeledSubgraph extractEgoNetwork(std::string const& center, uint32_t hops) const noexcept(false);
+    std::vector<LabeledSubgraph> extractEgoNetworks(std::vector<Node::integral_type> const& centers, uint32_t hops,
+                                                    unsigned threads = 0) const noexcept(false);
+
     std::string serialize() const override;
     void fromXml(std::string const& xml) override;
 
 private:
     uint32_t findNode(std::string const& label) const noexcept;
+    LabeledSubgraph withLabels(Subgraph&& subgraph) const;
+};
+
+// Part of a larger labeled graph: node i of `graph` is node localToGlobal[i] of the graph it was extracted from.
+struct LabeledSubgraph
+{
+    LabeledGraph graph;
+    std::vector<Node::integral_type> localToGlobal;
 };
 
 }
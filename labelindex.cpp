@@ -0,0 +1,456 @@
+#include "labelindex.h"
+#include "fileio.h"
+#include "labeledgraph.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Graphs
+{
+
+namespace
+{
+
+constexpr char formatMagic[4] = {'G', 'L', 'B', 'X'};
+constexpr uint32_t formatVersion = 1;
+constexpr uint32_t ignoreCaseFlag = 1;
+
+struct FileHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t flags;
+    uint32_t size;
+    uint32_t maxKeyLength;
+    uint64_t textBytes;
+    uint64_t fingerprint;
+};
+
+// FNV-1a over the labels in node order, each preceded by its length so that boundaries count.
+uint64_t fingerprintOf(LabeledGraph const& graph) noexcept
+{
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    auto mix = [&hash](uint8_t byte)
+    {
+        hash = (hash ^ byte) * 0x100000001B3ULL;
+    };
+    for (Node::integral_type node = 0; node < graph.getSize(); ++node)
+    {
+        std::string const& label = graph.getLabel(node);
+        uint64_t length = label.size();
+        for (unsigned shift = 0; shift < 64; shift += 8)
+        {
+            mix(static_cast<uint8_t>(length >> shift));
+        }
+        for (char character : label)
+        {
+            mix(static_cast<uint8_t>(character));
+        }
+    }
+    return hash;
+}
+
+// Keys may be empty and the text buffer with them, so memcmp() is only given non-null pointers.
+int compareKeys(char const* first, std::size_t firstLength, char const* second, std::size_t secondLength) noexcept
+{
+    std::size_t common = std::min(firstLength, secondLength);
+    int result = common == 0 ? 0 : std::memcmp(first, second, common);
+    if (result != 0)
+    {
+        return result;
+    }
+    return firstLength < secondLength ? -1 : firstLength > secondLength ? 1 : 0;
+}
+
+bool startsWith(char const* key, std::size_t keyLength, char const* prefix, std::size_t prefixLength) noexcept
+{
+    return keyLength >= prefixLength && (prefixLength == 0 || std::memcmp(key, prefix, prefixLength) == 0);
+}
+
+}
+
+LabelIndex::LabelIndex(LabeledGraph const& graph, LabelIndexOptions const& options) noexcept(false)
+    : m_text(), m_offsets(), m_nodes(), m_maxKeyLength{0}, m_fingerprint{fingerprintOf(graph)}, m_options{options}
+{
+    uint32_t size = graph.getSize();
+    // Normalized keys in node order first, then copied out in sorted order.
+    std::vector<char> text;
+    std::vector<uint64_t> starts(size + 1, 0);
+    for (Node::integral_type node = 0; node < size; ++node)
+    {
+        std::string key = normalize(graph.getLabel(node));
+        text.insert(text.end(), key.begin(), key.end());
+        starts[node + 1] = text.size();
+        m_maxKeyLength = std::max(m_maxKeyLength, static_cast<uint32_t>(key.size()));
+    }
+    if (text.size() > std::numeric_limits<uint32_t>::max())
+    {
+        throw std::length_error("Labels exceed the 4 GiB a label index can address");
+    }
+
+    m_nodes.resize(size);
+    std::iota(m_nodes.begin(), m_nodes.end(), 0);
+    std::sort(m_nodes.begin(), m_nodes.end(), [&text, &starts](Node::integral_type first, Node::integral_type second)
+    {
+        int order = compareKeys(text.data() + starts[first], starts[first + 1] - starts[first],
+                                text.data() + starts[second], starts[second + 1] - starts[second]);
+        return order < 0 || (order == 0 && first < second);
+    });
+    m_text.reserve(text.size());
+    m_offsets.reserve(size + 1);
+    m_offsets.push_back(0);
+    for (Node::integral_type node : m_nodes)
+    {
+        m_text.insert(m_text.end(), text.begin() + starts[node], text.begin() + starts[node + 1]);
+        m_offsets.push_back(static_cast<uint32_t>(m_text.size()));
+    }
+}
+
+LabelIndex::LabelIndex(std::string const& path) noexcept(false)
+    : m_text(), m_offsets(), m_nodes(), m_maxKeyLength{0}, m_fingerprint{0}, m_options{}
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        throw FileIo::error("Could not open", path);
+    }
+    try
+    {
+        struct stat status;
+        if (::fstat(fd, &status) != 0)
+        {
+            throw FileIo::error("Could not stat", path);
+        }
+        uint64_t fileSize = static_cast<uint64_t>(status.st_size);
+        FileHeader header;
+        if (fileSize < sizeof(header))
+        {
+            throw std::runtime_error("Not a label index file: " + path);
+        }
+        FileIo::readAll(fd, &header, sizeof(header), path);
+        if (std::memcmp(header.magic, formatMagic, sizeof(formatMagic)) != 0)
+        {
+            throw std::runtime_error("Not a label index file: " + path);
+        }
+        else if (header.version != formatVersion)
+        {
+            throw std::runtime_error("Unsupported label index file version in " + path);
+        }
+        else if (header.byteOrder != FileIo::byteOrderMark)
+        {
+            throw std::runtime_error("The label index file " + path + " was written with a different byte order");
+        }
+        else if (sizeof(header) + uint64_t{header.size} * sizeof(Node::integral_type)
+                 + (uint64_t{header.size} + 1) * sizeof(uint32_t) + header.textBytes != fileSize)
+        {
+            throw std::runtime_error("The label index file " + path + " is truncated");
+        }
+        m_options.ignoreCase = (header.flags & ignoreCaseFlag) != 0;
+        m_maxKeyLength = header.maxKeyLength;
+        m_fingerprint = header.fingerprint;
+        m_nodes.resize(header.size);
+        m_offsets.resize(uint64_t{header.size} + 1);
+        m_text.resize(header.textBytes);
+        FileIo::readAll(fd, m_nodes.data(), m_nodes.size() * sizeof(Node::integral_type), path);
+        FileIo::readAll(fd, m_offsets.data(), m_offsets.size() * sizeof(uint32_t), path);
+        FileIo::readAll(fd, m_text.data(), m_text.size(), path);
+    }
+    catch (...)
+    {
+        ::close(fd);
+        throw;
+    }
+    ::close(fd);
+    // Queries index the text through the offsets without bounds checks.
+    if (m_offsets.front() != 0 || m_offsets.back() != m_text.size()
+        || !std::is_sorted(m_offsets.begin(), m_offsets.end()))
+    {
+        throw std::runtime_error("The label index file " + path + " is corrupted");
+    }
+    for (uint32_t position = 0; position < getSize(); ++position)
+    {
+        if (getKeyLength(position) > m_maxKeyLength)
+        {
+            throw std::runtime_error("The label index file " + path + " is corrupted");
+        }
+    }
+}
+
+void LabelIndex::write(std::string const& path) const noexcept(false)
+{
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, formatMagic, sizeof(formatMagic));
+    header.version = formatVersion;
+    header.byteOrder = FileIo::byteOrderMark;
+    header.flags = m_options.ignoreCase ? ignoreCaseFlag : 0;
+    header.size = getSize();
+    header.maxKeyLength = m_maxKeyLength;
+    header.textBytes = m_text.size();
+    header.fingerprint = m_fingerprint;
+
+    std::string temporary = path + ".tmp";
+    int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        throw FileIo::error("Could not create", temporary);
+    }
+    try
+    {
+        FileIo::writeAll(fd, &header, sizeof(header), temporary);
+        FileIo::writeAll(fd, m_nodes.data(), m_nodes.size() * sizeof(Node::integral_type), temporary);
+        FileIo::writeAll(fd, m_offsets.data(), m_offsets.size() * sizeof(uint32_t), temporary);
+        FileIo::writeAll(fd, m_text.data(), m_text.size(), temporary);
+        if (::fsync(fd) != 0)
+        {
+            throw FileIo::error("Could not write", temporary);
+        }
+    }
+    catch (...)
+    {
+        ::close(fd);
+        ::unlink(temporary.c_str());
+        throw;
+    }
+    if (::close(fd) != 0 || ::rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        std::runtime_error error = FileIo::error("Could not write", temporary);
+        ::unlink(temporary.c_str());
+        throw error;
+    }
+}
+
+std::string LabelIndex::normalize(std::string const& label) const
+{
+    std::string key = label;
+    if (m_options.ignoreCase)
+    {
+        for (char& character : key)
+        {
+            if (character >= 'A' && character <= 'Z')
+            {
+                character = static_cast<char>(character - 'A' + 'a');
+            }
+        }
+    }
+    return key;
+}
+
+char const* LabelIndex::getKey(uint32_t position) const noexcept
+{
+    return m_text.data() + m_offsets[position];
+}
+
+uint32_t LabelIndex::getKeyLength(uint32_t position) const noexcept
+{
+    return m_offsets[position + 1] - m_offsets[position];
+}
+
+uint32_t LabelIndex::lowerBound(std::string const& prefix) const noexcept
+{
+    uint32_t first = 0;
+    uint32_t count = getSize();
+    while (count > 0)
+    {
+        uint32_t half = count / 2;
+        uint32_t middle = first + half;
+        if (compareKeys(getKey(middle), std::min<std::size_t>(getKeyLength(middle), prefix.size()), prefix.data(), prefix.size()) < 0)
+        {
+            first = middle + 1;
+            count -= half + 1;
+        }
+        else
+        {
+            count = half;
+        }
+    }
+    return first;
+}
+
+uint32_t LabelIndex::prefixEnd(uint32_t position, uint32_t length) const noexcept
+{
+    char const* prefix = getKey(position);
+    auto shares = [this, prefix, length](uint32_t other)
+    {
+        return startsWith(getKey(other), getKeyLength(other), prefix, length);
+    };
+    // Ranges are mostly short, so gallop before bisecting.
+    uint32_t size = getSize();
+    uint32_t low = position;
+    uint32_t step = 1;
+    while (true)
+    {
+        uint32_t probe = position + step < size ? position + step : size;
+        if (probe == size || !shares(probe))
+        {
+            uint32_t high = probe;
+            while (high - low > 1)
+            {
+                uint32_t middle = low + (high - low) / 2;
+                (shares(middle) ? low : high) = middle;
+            }
+            return high;
+        }
+        low = probe;
+        step = step > size ? size : step * 2;
+    }
+}
+
+uint32_t LabelIndex::getSize() const noexcept
+{
+    return static_cast<uint32_t>(m_nodes.size());
+}
+
+LabelIndexOptions const& LabelIndex::getOptions() const noexcept
+{
+    return m_options;
+}
+
+bool LabelIndex::matches(LabeledGraph const& graph) const noexcept
+{
+    return graph.getSize() == getSize() && fingerprintOf(graph) == m_fingerprint;
+}
+
+MemoryUsage LabelIndex::memoryUsage() const noexcept
+{
+    return MemoryUsage{0, 0, m_text.capacity(),
+                       sizeof(LabelIndex) + m_offsets.capacity() * sizeof(uint32_t) + m_nodes.capacity() * sizeof(Node::integral_type)};
+}
+
+std::vector<Node::integral_type> LabelIndex::find(std::string const& label) const noexcept(false)
+{
+    std::string key = normalize(label);
+    std::vector<Node::integral_type> nodes;
+    for (uint32_t position = lowerBound(key);
+         position < getSize() && compareKeys(getKey(position), getKeyLength(position), key.data(), key.size()) == 0; ++position)
+    {
+        nodes.push_back(m_nodes[position]);
+    }
+    return nodes;
+}
+
+uint32_t LabelIndex::countPrefix(std::string const& prefix) const noexcept(false)
+{
+    std::string key = normalize(prefix);
+    uint32_t first = lowerBound(key);
+    if (first == getSize() || !startsWith(getKey(first), getKeyLength(first), key.data(), key.size()))
+    {
+        return 0;
+    }
+    return prefixEnd(first, static_cast<uint32_t>(key.size())) - first;
+}
+
+std::vector<Node::integral_type> LabelIndex::findPrefix(std::string const& prefix, uint32_t limit) const noexcept(false)
+{
+    std::string key = normalize(prefix);
+    std::vector<Node::integral_type> nodes;
+    for (uint32_t position = lowerBound(key); position < getSize() && nodes.size() < limit; ++position)
+    {
+        if (!startsWith(getKey(position), getKeyLength(position), key.data(), key.size()))
+        {
+            break;
+        }
+        nodes.push_back(m_nodes[position]);
+    }
+    return nodes;
+}
+
+std::vector<LabelMatch> LabelIndex::findSimilar(std::string const& query, uint32_t maxDistance, uint32_t limit) const noexcept(false)
+{
+    std::vector<LabelMatch> matches;
+    if (limit == 0 || getSize() == 0)
+    {
+        return matches;
+    }
+    std::string pattern = normalize(query);
+    std::size_t width = pattern.size() + 1;
+    // Row d holds the distances between the first d bytes of the current key and every prefix of the pattern.
+    std::vector<uint32_t> rows((std::size_t{m_maxKeyLength} + 1) * width);
+    std::iota(rows.begin(), rows.begin() + width, 0);
+
+    // Best (distance, position) pairs so far with the worst on top; positions follow label order.
+    std::priority_queue<std::pair<uint32_t, uint32_t>> best;
+    // Largest distance still worth reporting; a full queue only takes keys strictly better than its worst,
+    // since later keys lose ties to earlier ones.
+    int64_t bound = maxDistance;
+    uint32_t size = getSize();
+    uint32_t position = 0;
+    uint32_t previous = 0;
+    uint32_t validRows = 0;
+    while (position < size && bound >= 0)
+    {
+        char const* key = getKey(position);
+        uint32_t length = getKeyLength(position);
+        // Rows for the bytes shared with the previous key are still in place.
+        char const* previousKey = getKey(previous);
+        uint32_t shared = std::min(validRows, length);
+        uint32_t depth = 0;
+        while (depth < shared && key[depth] == previousKey[depth])
+        {
+            ++depth;
+        }
+
+        bool skipped = false;
+        for (; depth < length; ++depth)
+        {
+            uint32_t const* above = rows.data() + depth * width;
+            uint32_t* row = rows.data() + (depth + 1) * width;
+            row[0] = depth + 1;
+            uint32_t minimum = row[0];
+            for (std::size_t column = 1; column < width; ++column)
+            {
+                uint32_t substitution = above[column - 1] + (pattern[column - 1] != key[depth] ? 1 : 0);
+                row[column] = std::min({above[column] + 1, row[column - 1] + 1, substitution});
+                minimum = std::min(minimum, row[column]);
+            }
+            if (minimum > bound)
+            {
+                // No key extending these depth + 1 bytes can get closer.
+                validRows = depth + 1;
+                previous = position;
+                position = prefixEnd(position, depth + 1);
+                skipped = true;
+                break;
+            }
+        }
+        if (skipped)
+        {
+            continue;
+        }
+
+        validRows = length;
+        previous = position;
+        uint32_t distance = rows[length * width + pattern.size()];
+        if (distance <= bound)
+        {
+            best.emplace(distance, position);
+            if (best.size() > limit)
+            {
+                best.pop();
+            }
+            if (best.size() == limit)
+            {
+                bound = static_cast<int64_t>(best.top().first) - 1;
+            }
+        }
+        ++position;
+    }
+
+    matches.resize(best.size());
+    for (std::size_t index = matches.size(); index-- > 0; best.pop())
+    {
+        matches[index] = LabelMatch{m_nodes[best.top().second], best.top().first};
+    }
+    return matches;
+}
+
+}
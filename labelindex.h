@@ -0,0 +1,84 @@
+#ifndef LABELINDEX_H
+#define LABELINDEX_H
+
+#include <string>
+#include <vector>
+#include "commontypes.hpp"
+#include "graph.h"
+
+namespace Graphs
+{
+
+// Forward declaration of LabeledGraph class
+class LabeledGraph;
+
+struct LabelIndexOptions
+{
+    // Fold ASCII letters to lower case in the index and in queries; other bytes, UTF-8 included, are kept.
+    bool ignoreCase = true;
+};
+
+struct LabelMatch
+{
+    Node::integral_type node;
+    uint32_t distance;
+};
+
+// Read-only index over the labels of a LabeledGraph for exact, prefix and approximate lookups. The keys
+// are stored sorted in one contiguous buffer with 32-bit offsets next to their node ids, so every node
+// with a given prefix forms one range found by binary search. Approximate queries walk the sorted keys
+// as an implicit trie: a Levenshtein row is computed per key byte and reused for the prefix shared with
+// the previous key, and once no extension of a prefix can be close enough, its whole range is skipped by
+// a galloping search. Distances count bytes, so a multi-byte UTF-8 character costs up to its length.
+// The index is a snapshot: later setLabel() calls are not reflected. It can be written next to the
+// graph's own files and checked against the graph with matches() after loading.
+class LabelIndex
+{
+private:
+    std::vector<char> m_text;
+    std::vector<uint32_t> m_offsets;
+    std::vector<Node::integral_type> m_nodes;
+    uint32_t m_maxKeyLength;
+    uint64_t m_fingerprint;
+    LabelIndexOptions m_options;
+
+    std::string normalize(std::string const& label) const;
+    char const* getKey(uint32_t position) const noexcept;
+    uint32_t getKeyLength(uint32_t position) const noexcept;
+    // First position of keys not below `prefix` when compared on at most prefix.size() bytes.
+    uint32_t lowerBound(std::string const& prefix) const noexcept;
+    // End of the run of keys starting at `position` that share its first `length` bytes.
+    uint32_t prefixEnd(uint32_t position, uint32_t length) const noexcept;
+
+public:
+    explicit LabelIndex(LabeledGraph const& graph, LabelIndexOptions const& options = LabelIndexOptions{}) noexcept(false);
+    // Loads an index saved with write().
+    explicit LabelIndex(std::string const& path) noexcept(false);
+    LabelIndex(LabelIndex const&) = default;
+    LabelIndex(LabelIndex&&) = default;
+    LabelIndex& operator=(LabelIndex const&) = default;
+    LabelIndex& operator=(LabelIndex&&) = default;
+    ~LabelIndex() = default;
+
+    // Written to a temporary file and renamed into place.
+    void write(std::string const& path) const noexcept(false);
+
+    uint32_t getSize() const noexcept;
+    LabelIndexOptions const& getOptions() const noexcept;
+    // Whether `graph` has exactly the labels the index was built from, compared by a 64-bit hash.
+    bool matches(LabeledGraph const& graph) const noexcept;
+    MemoryUsage memoryUsage() const noexcept;
+
+    // Nodes with the given label, in increasing id order.
+    std::vector<Node::integral_type> find(std::string const& label) const noexcept(false);
+    uint32_t countPrefix(std::string const& prefix) const noexcept(false);
+    // The first `limit` nodes whose label starts with `prefix`, in label order; an exact match comes first.
+    std::vector<Node::integral_type> findPrefix(std::string const& prefix, uint32_t limit = 10) const noexcept(false);
+    // The `limit` labels closest to `query` within `maxDistance` edits, ordered by distance, then label,
+    // then node id.
+    std::vector<LabelMatch> findSimilar(std::string const& query, uint32_t maxDistance, uint32_t limit = 10) const noexcept(false);
+};
+
+}
+
+#endif // LABELINDEX_H
@@ -1,7 +1,15 @@
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
 #include "graph.h"
 #include "labeledgraph.h"
 #include "algorithms.h"
+#include "queryengine.h"
+#include "queryserver.h"
 
 std::string graphXml = "<?xml version=\"1.0\"?>"
         "<Graph size=\"3\">"
@@ -24,8 +32,133 @@ std::string graphXml = "<?xml version=\"1.0\"?>"
 //            "</Edges>"
 //        "</LabeledGraph>";
 
-int main()
+// Parses a decimal option value in [0, maximum]; std::stoul alone would accept "-1" and trailing junk.
+static unsigned long parseNumber(std::string const& option, std::string const& value, unsigned long maximum)
 {
+    std::size_t parsed = 0;
+    unsigned long number = 0;
+    if (!value.empty() && value[0] >= '0' && value[0] <= '9')
+    {
+        try
+        {
+            number = std::stoul(value, &parsed);
+        }
+        catch (std::out_of_range&)
+        {
+            parsed = 0;
+        }
+    }
+    if (parsed == 0 || parsed != value.size() || number > maximum)
+    {
+        throw std::invalid_argument(option + " expects a number from 0 to " + std::to_string(maximum) + ", got '" + value + "'");
+    }
+    return number;
+}
+
+// graphs --serve <graph.xml> (--unix <path> | --tcp <port>) [--threads <count>]
+static int serve(int argc, char* argv[])
+{
+    constexpr unsigned long maxThreads = 1024;
+    std::string graphPath;
+    std::string unixPath;
+    int tcpPort = -1;
+    unsigned threads = 0;
+    try
+    {
+        for (int i = 1; i < argc; i += 2)
+        {
+            std::string option = argv[i];
+            if (i + 1 >= argc)
+            {
+                throw std::invalid_argument("Missing value for " + option);
+            }
+            std::string value = argv[i + 1];
+            if (option == "--serve")
+            {
+                graphPath = value;
+            }
+            else if (option == "--unix")
+            {
+                unixPath = value;
+            }
+            else if (option == "--tcp")
+            {
+                tcpPort = static_cast<int>(parseNumber(option, value, std::numeric_limits<uint16_t>::max()));
+            }
+            else if (option == "--threads")
+            {
+                threads = static_cast<unsigned>(parseNumber(option, value, maxThreads));
+            }
+            else
+            {
+                throw std::invalid_argument("Unknown option " + option);
+            }
+        }
+        if (graphPath.empty() || (unixPath.empty() == (tcpPort < 0)))
+        {
+            throw std::invalid_argument("Give a graph and exactly one of --unix and --tcp");
+        }
+    }
+    catch (std::invalid_argument& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cerr << "usage: " << argv[0] << " --serve <graph.xml> (--unix <path> | --tcp <port>) [--threads <count>]" << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        std::ifstream file(graphPath);
+        if (!file.is_open())
+        {
+            std::cerr << "Could not open " << graphPath << std::endl;
+            return 1;
+        }
+        std::stringstream content;
+        content << file.rdbuf();
+        std::string xml = content.str();
+
+        std::unique_ptr<Graphs::QueryEngine> engine;
+        if (xml.find("<LabeledGraph") != std::string::npos)
+        {
+            Graphs::LabeledGraph graph{};
+            graph.fromXml(xml);
+            engine.reset(new Graphs::QueryEngine(graph, threads));
+        }
+        else
+        {
+            Graphs::Graph graph{};
+            graph.fromXml(xml);
+            engine.reset(new Graphs::QueryEngine(graph, threads));
+        }
+
+        Graphs::QueryServer server{*engine};
+        if (!unixPath.empty())
+        {
+            server.listenUnix(unixPath);
+        }
+        else
+        {
+            server.listenTcp(static_cast<uint16_t>(tcpPort));
+        }
+        std::cout << "Serving " << engine->getSize() << " nodes with " << engine->getThreadsCount() << " threads" << std::endl;
+        server.run();
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc > 1)
+    {
+        return serve(argc, argv);
+    }
+
     Graphs::Graph graph{};
     try
     {
@@ -0,0 +1,565 @@
+#include "maximumflow.h"
+#include "adjacencylist.h"
+#include "graph.h"
+#include "labeledgraph.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <stdexcept>
+#include <limits>
+
+namespace Graphs
+{
+
+namespace Algorithms
+{
+
+namespace
+{
+
+using node_type = Node::integral_type;
+using arc_type = uint32_t;
+
+// Residual network: original edge i owns arc 2i (forward) and arc 2i + 1 (reverse), so the
+// partner of any arc is arc ^ 1 and the flow of edge i is the residual capacity of arc 2i + 1.
+struct ResidualNetwork
+{
+    uint32_t size;
+    std::vector<node_type> heads;
+    std::vector<int32_t> residual;
+    std::vector<int32_t> capacity;
+    std::vector<std::size_t> firstArc;
+    std::vector<arc_type> arcs;
+
+    explicit ResidualNetwork(AdjacencyList const& adjacency);
+
+    node_type tail(arc_type arc) const
+    {
+        return heads[arc ^ 1];
+    }
+};
+
+ResidualNetwork::ResidualNetwork(AdjacencyList const& adjacency) : size(adjacency.getSize()), heads(), residual(), capacity(),
+                                                                   firstArc(adjacency.getSize() + 1, 0), arcs()
+{
+    std::size_t edges = adjacency.getEdgesCount();
+    if (edges * 2 > std::numeric_limits<arc_type>::max())
+    {
+        throw std::invalid_argument("The graph has too many edges for the flow network");
+    }
+    heads.resize(edges * 2);
+    residual.resize(edges * 2);
+    capacity.resize(edges);
+    for (node_type src = 0; src < size; ++src)
+    {
+        for (std::size_t edge = adjacency.edgesBegin(src); edge < adjacency.edgesEnd(src); ++edge)
+        {
+            if (adjacency.getWeight(edge) < 0)
+            {
+                throw std::invalid_argument("Capacities must not be negative");
+            }
+            heads[2 * edge] = adjacency.getTarget(edge);
+            heads[2 * edge + 1] = src;
+            residual[2 * edge] = adjacency.getWeight(edge);
+            residual[2 * edge + 1] = 0;
+            capacity[edge] = adjacency.getWeight(edge);
+            ++firstArc[src + 1];
+            ++firstArc[adjacency.getTarget(edge) + 1];
+        }
+    }
+    for (node_type node = 0; node < size; ++node)
+    {
+        firstArc[node + 1] += firstArc[node];
+    }
+    arcs.resize(firstArc.back());
+    std::vector<std::size_t> cursor(firstArc.begin(), firstArc.end() - 1);
+    for (arc_type arc = 0; arc < heads.size(); ++arc)
+    {
+        arcs[cursor[tail(arc)]++] = arc;
+    }
+}
+
+// Breadth-first distances to `target` over arcs with residual capacity; unreachable nodes get `unreachable`.
+void distancesTo(ResidualNetwork const& network, node_type target, uint32_t unreachable, std::vector<uint32_t>& labels,
+                 std::vector<node_type>& queue)
+{
+    std::fill(labels.begin(), labels.end(), unreachable);
+    labels[target] = 0;
+    queue.clear();
+    queue.push_back(target);
+    for (std::size_t head = 0; head < queue.size(); ++head)
+    {
+        node_type node = queue[head];
+        for (std::size_t slot = network.firstArc[node]; slot < network.firstArc[node + 1]; ++slot)
+        {
+            arc_type arc = network.arcs[slot];
+            node_type other = network.heads[arc];
+            if (labels[other] == unreachable && network.residual[arc ^ 1] > 0)
+            {
+                labels[other] = labels[node] + 1;
+                queue.push_back(other);
+            }
+        }
+    }
+}
+
+// Highest-label push-relabel. Phase one moves a maximum preflow to the sink using gap relabeling
+// and periodic global relabeling; phase two returns the remaining excess to the source.
+class PushRelabel
+{
+private:
+    ResidualNetwork& m_network;
+    node_type m_source;
+    node_type m_sink;
+    uint32_t m_size;
+    std::vector<int64_t> m_excess;
+    std::vector<uint32_t> m_labels;
+    std::vector<std::size_t> m_current;
+    std::vector<std::vector<node_type>> m_active;
+    std::vector<node_type> m_next;
+    std::vector<node_type> m_previous;
+    std::vector<node_type> m_bucketHeads;
+    std::vector<node_type> m_queue;
+    uint32_t m_maxActive;
+    uint32_t m_maxLabel;
+    std::size_t m_relabels;
+
+    static constexpr node_type none = std::numeric_limits<node_type>::max();
+
+    void link(node_type node)
+    {
+        uint32_t label = m_labels[node];
+        m_previous[node] = none;
+        m_next[node] = m_bucketHeads[label];
+        if (m_bucketHeads[label] != none)
+        {
+            m_previous[m_bucketHeads[label]] = node;
+        }
+        m_bucketHeads[label] = node;
+        m_maxLabel = std::max(m_maxLabel, label);
+    }
+
+    void unlink(node_type node)
+    {
+        if (m_previous[node] != none)
+        {
+            m_next[m_previous[node]] = m_next[node];
+        }
+        else
+        {
+            m_bucketHeads[m_labels[node]] = m_next[node];
+        }
+        if (m_next[node] != none)
+        {
+            m_previous[m_next[node]] = m_previous[node];
+        }
+    }
+
+    void activate(node_type node)
+    {
+        m_active[m_labels[node]].push_back(node);
+        m_maxActive = std::max(m_maxActive, m_labels[node]);
+    }
+
+    void globalRelabel()
+    {
+        distancesTo(m_network, m_sink, m_size, m_labels, m_queue);
+        m_labels[m_source] = m_size;
+        std::fill(m_bucketHeads.begin(), m_bucketHeads.end(), none);
+        for (auto&& bucket : m_active)
+        {
+            bucket.clear();
+        }
+        m_maxActive = 0;
+        m_maxLabel = 0;
+        for (node_type node = 0; node < m_size; ++node)
+        {
+            m_current[node] = m_network.firstArc[node];
+            if (m_labels[node] < m_size)
+            {
+                link(node);
+                if (m_excess[node] > 0 && node != m_sink)
+                {
+                    activate(node);
+                }
+            }
+        }
+        m_relabels = 0;
+    }
+
+    void gap(uint32_t emptied)
+    {
+        for (uint32_t label = emptied + 1; label <= m_maxLabel; ++label)
+        {
+            for (node_type node = m_bucketHeads[label]; node != none; node = m_next[node])
+            {
+                m_labels[node] = m_size;
+            }
+            m_bucketHeads[label] = none;
+        }
+        m_maxLabel = (emptied == 0) ? 0 : emptied - 1;
+    }
+
+    void push(node_type node, arc_type arc, bool phaseOne)
+    {
+        node_type other = m_network.heads[arc];
+        int64_t amount = std::min<int64_t>(m_excess[node], m_network.residual[arc]);
+        m_network.residual[arc] -= static_cast<int32_t>(amount);
+        m_network.residual[arc ^ 1] += static_cast<int32_t>(amount);
+        bool wasIdle = (m_excess[other] == 0);
+        m_excess[node] -= amount;
+        m_excess[other] += amount;
+        if (wasIdle && other != m_sink && other != m_source)
+        {
+            if (phaseOne)
+            {
+                activate(other);
+            }
+            else
+            {
+                m_queue.push_back(other);
+            }
+        }
+    }
+
+    // Lowest neighbour label + 1 over residual arcs.
+    uint32_t relabel(node_type node, uint32_t limit)
+    {
+        uint32_t lowest = limit;
+        for (std::size_t slot = m_network.firstArc[node]; slot < m_network.firstArc[node + 1]; ++slot)
+        {
+            arc_type arc = m_network.arcs[slot];
+            if (m_network.residual[arc] > 0)
+            {
+                lowest = std::min(lowest, m_labels[m_network.heads[arc]] + 1);
+            }
+        }
+        m_current[node] = m_network.firstArc[node];
+        ++m_relabels;
+        return lowest;
+    }
+
+    void dischargeTowardsSink(node_type node)
+    {
+        while (m_excess[node] > 0)
+        {
+            std::size_t end = m_network.firstArc[node + 1];
+            for (; m_current[node] < end && m_excess[node] > 0; ++m_current[node])
+            {
+                arc_type arc = m_network.arcs[m_current[node]];
+                if (m_network.residual[arc] > 0 && m_labels[node] == m_labels[m_network.heads[arc]] + 1)
+                {
+                    push(node, arc, true);
+                    if (m_excess[node] == 0)
+                    {
+                        break;
+                    }
+                }
+            }
+            if (m_excess[node] == 0)
+            {
+                break;
+            }
+
+            uint32_t old = m_labels[node];
+            unlink(node);
+            if (m_bucketHeads[old] == none)
+            {
+                // Nothing is left at this label, so every node above it is cut off from the sink.
+                m_labels[node] = m_size;
+                gap(old);
+                break;
+            }
+            m_labels[node] = relabel(node, m_size);
+            if (m_labels[node] >= m_size)
+            {
+                m_labels[node] = m_size;
+                break;
+            }
+            link(node);
+        }
+    }
+
+    void phaseOne()
+    {
+        m_labels.assign(m_size, 0);
+        for (std::size_t slot = m_network.firstArc[m_source]; slot < m_network.firstArc[m_source + 1]; ++slot)
+        {
+            arc_type arc = m_network.arcs[slot];
+            int32_t amount = m_network.residual[arc];
+            if (amount > 0)
+            {
+                m_network.residual[arc] = 0;
+                m_network.residual[arc ^ 1] += amount;
+                m_excess[m_network.heads[arc]] += amount;
+                m_excess[m_source] -= amount;
+            }
+        }
+        globalRelabel();
+
+        while (true)
+        {
+            while (m_maxActive > 0 && m_active[m_maxActive].empty())
+            {
+                --m_maxActive;
+            }
+            if (m_active[m_maxActive].empty())
+            {
+                break;
+            }
+            node_type node = m_active[m_maxActive].back();
+            m_active[m_maxActive].pop_back();
+            if (m_labels[node] != m_maxActive || m_excess[node] == 0)
+            {
+                continue;
+            }
+            dischargeTowardsSink(node);
+            if (m_relabels >= m_size)
+            {
+                globalRelabel();
+            }
+        }
+    }
+
+    void phaseTwo()
+    {
+        // Excess left on nodes cut off from the sink flows back along residual arcs towards the source.
+        distancesTo(m_network, m_source, 2 * m_size, m_labels, m_queue);
+        m_labels[m_sink] = 2 * m_size;
+        m_queue.clear();
+        for (node_type node = 0; node < m_size; ++node)
+        {
+            m_current[node] = m_network.firstArc[node];
+            if (m_excess[node] > 0 && node != m_source && node != m_sink)
+            {
+                m_queue.push_back(node);
+            }
+        }
+        for (std::size_t head = 0; head < m_queue.size(); ++head)
+        {
+            node_type node = m_queue[head];
+            while (m_excess[node] > 0)
+            {
+                std::size_t end = m_network.firstArc[node + 1];
+                for (; m_current[node] < end && m_excess[node] > 0; ++m_current[node])
+                {
+                    arc_type arc = m_network.arcs[m_current[node]];
+                    if (m_network.residual[arc] > 0 && m_labels[node] == m_labels[m_network.heads[arc]] + 1)
+                    {
+                        push(node, arc, false);
+                        if (m_excess[node] == 0)
+                        {
+                            break;
+                        }
+                    }
+                }
+                if (m_excess[node] > 0)
+                {
+                    m_labels[node] = relabel(node, 2 * m_size);
+                }
+            }
+        }
+    }
+
+public:
+    PushRelabel(ResidualNetwork& network, node_type source, node_type sink)
+        : m_network(network), m_source(source), m_sink(sink), m_size(network.size), m_excess(network.size, 0),
+          m_labels(network.size, 0), m_current(network.size, 0), m_active(network.size + 1), m_next(network.size, none),
+          m_previous(network.size, none), m_bucketHeads(network.size + 1, none), m_queue(), m_maxActive(0), m_maxLabel(0),
+          m_relabels(0)
+    {
+    }
+
+    int64_t run()
+    {
+        phaseOne();
+        int64_t value = m_excess[m_sink];
+        phaseTwo();
+        return value;
+    }
+};
+
+constexpr node_type PushRelabel::none;
+
+int64_t dinic(ResidualNetwork& network, node_type source, node_type sink)
+{
+    uint32_t size = network.size;
+    std::vector<uint32_t> levels(size);
+    std::vector<std::size_t> current(size);
+    std::vector<node_type> queue;
+    std::vector<arc_type> path;
+    queue.reserve(size);
+    int64_t total = 0;
+    constexpr uint32_t unreached = std::numeric_limits<uint32_t>::max();
+
+    while (true)
+    {
+        std::fill(levels.begin(), levels.end(), unreached);
+        levels[source] = 0;
+        queue.clear();
+        queue.push_back(source);
+        for (std::size_t head = 0; head < queue.size() && levels[sink] == unreached; ++head)
+        {
+            node_type node = queue[head];
+            for (std::size_t slot = network.firstArc[node]; slot < network.firstArc[node + 1]; ++slot)
+            {
+                arc_type arc = network.arcs[slot];
+                if (network.residual[arc] > 0 && levels[network.heads[arc]] == unreached)
+                {
+                    levels[network.heads[arc]] = levels[node] + 1;
+                    queue.push_back(network.heads[arc]);
+                }
+            }
+        }
+        if (levels[sink] == unreached)
+        {
+            break;
+        }
+
+        // Iterative blocking-flow search with current-arc pointers; dead ends are pruned by clearing their level.
+        for (node_type node = 0; node < size; ++node)
+        {
+            current[node] = network.firstArc[node];
+        }
+        path.clear();
+        node_type node = source;
+        while (true)
+        {
+            if (node == sink)
+            {
+                int32_t bottleneck = std::numeric_limits<int32_t>::max();
+                for (auto&& arc : path)
+                {
+                    bottleneck = std::min(bottleneck, network.residual[arc]);
+                }
+                std::size_t firstSaturated = path.size();
+                for (std::size_t i = 0; i < path.size(); ++i)
+                {
+                    network.residual[path[i]] -= bottleneck;
+                    network.residual[path[i] ^ 1] += bottleneck;
+                    if (network.residual[path[i]] == 0 && firstSaturated == path.size())
+                    {
+                        firstSaturated = i;
+                    }
+                }
+                total += bottleneck;
+                path.resize(firstSaturated);
+                node = path.empty() ? source : network.heads[path.back()];
+                continue;
+            }
+
+            bool advanced = false;
+            for (; current[node] < network.firstArc[node + 1]; ++current[node])
+            {
+                arc_type arc = network.arcs[current[node]];
+                node_type other = network.heads[arc];
+                if (network.residual[arc] > 0 && levels[other] != unreached && levels[other] == levels[node] + 1)
+                {
+                    path.push_back(arc);
+                    node = other;
+                    advanced = true;
+                    break;
+                }
+            }
+            if (advanced)
+            {
+                continue;
+            }
+            if (node == source)
+            {
+                break;
+            }
+            levels[node] = unreached;
+            node = network.tail(path.back());
+            path.pop_back();
+            ++current[node];
+        }
+    }
+    return total;
+}
+
+}
+
+static MaximumFlow maximumFlowImpl(Graph const& graph, Node const& source, Node const& sink, FlowAlgorithm algorithm) noexcept(false);
+
+MaximumFlow maximumFlow(Graph const& graph, Node const& source, Node const& sink, FlowAlgorithm algorithm) noexcept(false)
+{
+    return maximumFlowImpl(graph, source, sink, algorithm);
+}
+
+MaximumFlow maximumFlow(LabeledGraph const& graph, LabeledNode const& source, LabeledNode const& sink, FlowAlgorithm algorithm) noexcept(false)
+{
+    return maximumFlowImpl(graph.getRawGraph(), source.node, sink.node, algorithm);
+}
+
+MaximumFlow maximumFlow(LabeledGraph const& graph, std::string const& source, std::string const& sink, FlowAlgorithm algorithm) noexcept(false)
+{
+    return maximumFlowImpl(graph.getRawGraph(), graph.getNode(source).node, graph.getNode(sink).node, algorithm);
+}
+
+// =====================================================
+//                   IMPLEMENTATION
+// =====================================================
+
+MaximumFlow maximumFlowImpl(Graph const& graph, Node const& source, Node const& sink, FlowAlgorithm algorithm) noexcept(false)
+{
+    if (!graph.contains(source) || !graph.contains(sink))
+    {
+        throw std::invalid_argument("Source or sink node does not exist in the graph");
+    }
+    else if (source == sink)
+    {
+        throw std::invalid_argument("Source and sink must be different nodes");
+    }
+
+    AdjacencyList adjacency{graph};
+    ResidualNetwork network{adjacency};
+    MaximumFlow result{0, {}, {}, std::vector<uint8_t>(network.size, 0)};
+    if (algorithm == FlowAlgorithm::Dinic)
+    {
+        result.value = dinic(network, source.id, sink.id);
+    }
+    else
+    {
+        result.value = PushRelabel{network, source.id, sink.id}.run();
+    }
+
+    std::vector<node_type> queue{source.id};
+    result.sourceSide[source.id] = 1;
+    for (std::size_t head = 0; head < queue.size(); ++head)
+    {
+        node_type node = queue[head];
+        for (std::size_t slot = network.firstArc[node]; slot < network.firstArc[node + 1]; ++slot)
+        {
+            arc_type arc = network.arcs[slot];
+            if (network.residual[arc] > 0 && result.sourceSide[network.heads[arc]] == 0)
+            {
+                result.sourceSide[network.heads[arc]] = 1;
+                queue.push_back(network.heads[arc]);
+            }
+        }
+    }
+
+    for (node_type src = 0; src < network.size; ++src)
+    {
+        for (std::size_t edge = adjacency.edgesBegin(src); edge < adjacency.edgesEnd(src); ++edge)
+        {
+            node_type target = adjacency.getTarget(edge);
+            int32_t flow = network.residual[2 * edge + 1];
+            if (flow > 0)
+            {
+                result.flows.push_back(Edge{Node{src}, Node{target}, static_cast<edge_weight_type>(flow), EdgeDirection::Directed});
+            }
+            if (result.sourceSide[src] != 0 && result.sourceSide[target] == 0)
+            {
+                result.cut.push_back(Edge{Node{src}, Node{target}, adjacency.getWeight(edge), EdgeDirection::Directed});
+            }
+        }
+    }
+    return result;
+}
+
+}
+
+}
@@ -0,0 +1,43 @@
+#ifndef MAXIMUMFLOW_H
+#define MAXIMUMFLOW_H
+
+#include <vector>
+#include "commontypes.hpp"
+
+namespace Graphs
+{
+
+// Forward declaration of Graph class
+class Graph;
+// Forward declaration of LabeledGraph class
+class LabeledGraph;
+
+namespace Algorithms
+{
+
+enum class FlowAlgorithm : uint8_t
+{
+    PushRelabel,
+    Dinic
+};
+
+// Edge weights are capacities of the directed matrix entries (an undirected edge is two arcs).
+// `flows` lists every edge carrying flow with the flow as its weight, `cut` the saturated edges
+// leaving the source side of a minimum cut with their capacities.
+struct MaximumFlow
+{
+    int64_t value;
+    std::vector<Edge> flows;
+    std::vector<Edge> cut;
+    std::vector<uint8_t> sourceSide;
+};
+
+MaximumFlow maximumFlow(Graph const& graph, Node const& source, Node const& sink, FlowAlgorithm algorithm = FlowAlgorithm::PushRelabel) noexcept(false);
+MaximumFlow maximumFlow(LabeledGraph const& graph, LabeledNode const& source, LabeledNode const& sink, FlowAlgorithm algorithm = FlowAlgorithm::PushRelabel) noexcept(false);
+MaximumFlow maximumFlow(LabeledGraph const& graph, std::string const& source, std::string const& sink, FlowAlgorithm algorithm = FlowAlgorithm::PushRelabel) noexcept(false);
+
+}
+
+}
+
+#endif // MAXIMUMFLOW_H
@@ -0,0 +1,131 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Graphs
+{
+
+namespace Parallel
+{
+
+inline unsigned threadsCount(unsigned requested) noexcept
+{
+    if (requested != 0)
+    {
+        return requested;
+    }
+    unsigned hardware = std::thread::hardware_concurrency();
+    return (hardware == 0) ? 1 : hardware;
+}
+
+// Calls function(worker, index) for every index in [0, count) using up to `threads` workers.
+// Indices are handed out in chunks from a shared counter, so uneven work balances itself.
+// The first exception thrown by any worker is rethrown in the calling thread.
+template <typename Function>
+void forEach(std::size_t count, unsigned threads, Function&& function, std::size_t chunk = 64) noexcept(false)
+{
+    chunk = std::max<std::size_t>(chunk, 1);
+    unsigned workers = static_cast<unsigned>(std::min<std::size_t>(threadsCount(threads), (count + chunk - 1) / chunk));
+    if (workers <= 1)
+    {
+        for (std::size_t index = 0; index < count; ++index)
+        {
+            function(0U, index);
+        }
+        return;
+    }
+
+    std::atomic<std::size_t> next{0};
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    auto work = [&](unsigned worker)
+    {
+        try
+        {
+            for (std::size_t begin = next.fetch_add(chunk); begin < count; begin = next.fetch_add(chunk))
+            {
+                std::size_t end = std::min(begin + chunk, count);
+                for (std::size_t index = begin; index < end; ++index)
+                {
+                    function(worker, index);
+                }
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error)
+            {
+                error = std::current_exception();
+            }
+            next.store(count);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    for (unsigned worker = 1; worker < workers; ++worker)
+    {
+        pool.emplace_back(work, worker);
+    }
+    work(0);
+    for (auto&& thread : pool)
+    {
+        thread.join();
+    }
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+// Sorts [first, last) by sorting equal slices concurrently and merging them pairwise.
+template <typename RandomIt, typename Compare>
+void sort(RandomIt first, RandomIt last, Compare compare, unsigned threads = 0) noexcept(false)
+{
+    std::size_t count = static_cast<std::size_t>(last - first);
+    std::size_t slices = std::min<std::size_t>(threadsCount(threads), std::max<std::size_t>(count / 4096, 1));
+    if (slices <= 1)
+    {
+        std::sort(first, last, compare);
+        return;
+    }
+
+    std::vector<std::size_t> bounds(slices + 1);
+    for (std::size_t slice = 0; slice <= slices; ++slice)
+    {
+        bounds[slice] = count * slice / slices;
+    }
+    forEach(slices, threads, [&](unsigned, std::size_t slice)
+    {
+        std::sort(first + bounds[slice], first + bounds[slice + 1], compare);
+    }, 1);
+
+    for (std::size_t width = 1; width < slices; width *= 2)
+    {
+        std::size_t merges = (slices + 2 * width - 1) / (2 * width);
+        forEach(merges, threads, [&](unsigned, std::size_t merge)
+        {
+            std::size_t low = merge * 2 * width;
+            std::size_t middle = std::min(low + width, slices);
+            std::size_t high = std::min(low + 2 * width, slices);
+            if (middle < high)
+            {
+                std::inplace_merge(first + bounds[low], first + bounds[middle], first + bounds[high], compare);
+            }
+        }, 1);
+    }
+}
+
+}
+
+}
+
+#endif // PARALLEL_H
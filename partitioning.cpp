@@ -0,0 +1,660 @@
+#include "partitioning.h"
+#include "adjacencylist.h"
+#include "labeledgraph.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <stdexcept>
+
+namespace Graphs
+{
+
+namespace Algorithms
+{
+
+namespace
+{
+
+using node_type = Node::integral_type;
+
+// Undirected graph with node and edge weights, as used on every coarsening level.
+struct Level
+{
+    std::vector<std::size_t> offsets;
+    std::vector<node_type> targets;
+    std::vector<uint64_t> edgeWeights;
+    std::vector<uint64_t> nodeWeights;
+    // Coarse node of every node of the finer level this one was built from.
+    std::vector<node_type> fineToCoarse;
+
+    node_type size() const
+    {
+        return static_cast<node_type>(nodeWeights.size());
+    }
+};
+
+Level fromAdjacency(AdjacencyList const& undirected)
+{
+    Level level;
+    level.offsets.assign(undirected.getSize() + 1, 0);
+    for (node_type node = 0; node < undirected.getSize(); ++node)
+    {
+        level.offsets[node + 1] = undirected.edgesEnd(node);
+    }
+    level.targets.assign(undirected.targetsBegin(0), undirected.targetsBegin(0) + undirected.getEdgesCount());
+    level.edgeWeights.assign(undirected.getEdgesCount(), 1);
+    level.nodeWeights.assign(undirected.getSize(), 1);
+    return level;
+}
+
+// Heavy-edge matching: every node, in random order, pairs with the unmatched neighbour it shares the
+// heaviest edge with, unless the pair would outweigh `maxNodeWeight`. Pairs collapse into one node.
+Level coarsen(Level const& fine, uint64_t maxNodeWeight, std::mt19937_64& random)
+{
+    node_type size = fine.size();
+    std::vector<node_type> order(size);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), random);
+
+    constexpr node_type unmatched = std::numeric_limits<node_type>::max();
+    std::vector<node_type> match(size, unmatched);
+    for (node_type node : order)
+    {
+        if (match[node] != unmatched)
+        {
+            continue;
+        }
+        node_type best = node;
+        uint64_t bestWeight = 0;
+        for (std::size_t edge = fine.offsets[node]; edge < fine.offsets[node + 1]; ++edge)
+        {
+            node_type target = fine.targets[edge];
+            if (match[target] == unmatched && target != node && fine.edgeWeights[edge] > bestWeight
+                    && fine.nodeWeights[node] + fine.nodeWeights[target] <= maxNodeWeight)
+            {
+                best = target;
+                bestWeight = fine.edgeWeights[edge];
+            }
+        }
+        match[node] = best;
+        match[best] = node;
+    }
+
+    Level coarse;
+    coarse.fineToCoarse.assign(size, unmatched);
+    for (node_type node = 0; node < size; ++node)
+    {
+        if (coarse.fineToCoarse[node] == unmatched)
+        {
+            coarse.fineToCoarse[node] = coarse.fineToCoarse[match[node]] = static_cast<node_type>(coarse.nodeWeights.size());
+            coarse.nodeWeights.push_back(fine.nodeWeights[node] + (match[node] != node ? fine.nodeWeights[match[node]] : 0));
+        }
+    }
+
+    // Merge the rows of each pair, summing the weights of parallel edges and dropping the inner one.
+    node_type coarseSize = coarse.size();
+    std::vector<node_type> members(coarseSize * 2, unmatched);
+    for (node_type node = 0; node < size; ++node)
+    {
+        node_type slot = coarse.fineToCoarse[node] * 2;
+        members[members[slot] == unmatched ? slot : slot + 1] = node;
+    }
+    std::vector<std::size_t> position(coarseSize, std::numeric_limits<std::size_t>::max());
+    coarse.offsets.reserve(coarseSize + 1);
+    coarse.offsets.push_back(0);
+    for (node_type target = 0; target < coarseSize; ++target)
+    {
+        std::size_t rowBegin = coarse.targets.size();
+        for (int member = 0; member < 2; ++member)
+        {
+            node_type node = members[target * 2 + member];
+            if (node == unmatched)
+            {
+                continue;
+            }
+            for (std::size_t edge = fine.offsets[node]; edge < fine.offsets[node + 1]; ++edge)
+            {
+                node_type neighbour = coarse.fineToCoarse[fine.targets[edge]];
+                if (neighbour == target)
+                {
+                    continue;
+                }
+                if (position[neighbour] == std::numeric_limits<std::size_t>::max() || position[neighbour] < rowBegin)
+                {
+                    position[neighbour] = coarse.targets.size();
+                    coarse.targets.push_back(neighbour);
+                    coarse.edgeWeights.push_back(fine.edgeWeights[edge]);
+                }
+                else
+                {
+                    coarse.edgeWeights[position[neighbour]] += fine.edgeWeights[edge];
+                }
+            }
+        }
+        coarse.offsets.push_back(coarse.targets.size());
+    }
+    return coarse;
+}
+
+// Breadth-first region growing: parts are filled one after another along a BFS order, so each is a
+// connected-ish region; refinement then repairs the seams.
+std::vector<uint32_t> initialPartition(Level const& level, uint32_t parts, std::mt19937_64& random)
+{
+    node_type size = level.size();
+    uint64_t total = std::accumulate(level.nodeWeights.begin(), level.nodeWeights.end(), uint64_t{0});
+    std::vector<uint32_t> assignment(size, 0);
+    std::vector<uint8_t> visited(size, 0);
+    std::vector<node_type> queue;
+    queue.reserve(size);
+    std::vector<node_type> starts(size);
+    std::iota(starts.begin(), starts.end(), 0);
+    std::shuffle(starts.begin(), starts.end(), random);
+
+    uint32_t part = 0;
+    uint64_t filled = 0;
+    for (node_type start : starts)
+    {
+        if (visited[start] != 0)
+        {
+            continue;
+        }
+        visited[start] = 1;
+        queue.assign(1, start);
+        for (std::size_t head = 0; head < queue.size(); ++head)
+        {
+            node_type node = queue[head];
+            // Part p ends once the nodes placed so far reach (p + 1) / k of the total weight.
+            while (part + 1 < parts && filled * parts >= total * (part + 1))
+            {
+                ++part;
+            }
+            assignment[node] = part;
+            filled += level.nodeWeights[node];
+            for (std::size_t edge = level.offsets[node]; edge < level.offsets[node + 1]; ++edge)
+            {
+                node_type target = level.targets[edge];
+                if (visited[target] == 0)
+                {
+                    visited[target] = 1;
+                    queue.push_back(target);
+                }
+            }
+        }
+    }
+    return assignment;
+}
+
+// Greedy k-way boundary refinement. Nodes move to the neighbouring part they are most connected to
+// when that lowers the cut without overfilling it, or when it drains an overweight part.
+void refine(Level const& level, std::vector<uint32_t>& assignment, uint32_t parts, uint64_t maxPartWeight, std::mt19937_64& random)
+{
+    node_type size = level.size();
+    std::vector<uint64_t> partWeights(parts, 0);
+    for (node_type node = 0; node < size; ++node)
+    {
+        partWeights[assignment[node]] += level.nodeWeights[node];
+    }
+    std::vector<node_type> order(size);
+    std::iota(order.begin(), order.end(), 0);
+    std::vector<uint64_t> connection(parts, 0);
+    std::vector<uint32_t> touched;
+    touched.reserve(parts);
+
+    for (int pass = 0; pass < 8; ++pass)
+    {
+        std::shuffle(order.begin(), order.end(), random);
+        std::size_t moves = 0;
+        for (node_type node : order)
+        {
+            uint32_t from = assignment[node];
+            for (std::size_t edge = level.offsets[node]; edge < level.offsets[node + 1]; ++edge)
+            {
+                uint32_t part = assignment[level.targets[edge]];
+                if (connection[part] == 0)
+                {
+                    touched.push_back(part);
+                }
+                connection[part] += level.edgeWeights[edge];
+            }
+
+            bool overweight = partWeights[from] > maxPartWeight;
+            uint32_t best = from;
+            int64_t bestGain = 0;
+            for (uint32_t part : touched)
+            {
+                if (part == from || partWeights[part] + level.nodeWeights[node] > maxPartWeight)
+                {
+                    continue;
+                }
+                int64_t gain = static_cast<int64_t>(connection[part]) - static_cast<int64_t>(connection[from]);
+                bool balances = partWeights[part] + level.nodeWeights[node] < partWeights[from];
+                if (gain > bestGain || (best == from && (overweight || (gain == 0 && balances)))
+                        || (best != from && gain == bestGain && partWeights[part] < partWeights[best]))
+                {
+                    best = part;
+                    bestGain = gain;
+                }
+            }
+            if (overweight && best == from)
+            {
+                // Isolated from lighter parts: fall back to the lightest part overall.
+                uint32_t lightest = static_cast<uint32_t>(std::min_element(partWeights.begin(), partWeights.end()) - partWeights.begin());
+                if (partWeights[lightest] + level.nodeWeights[node] <= maxPartWeight)
+                {
+                    best = lightest;
+                }
+            }
+            for (uint32_t part : touched)
+            {
+                connection[part] = 0;
+            }
+            touched.clear();
+
+            if (best != from)
+            {
+                partWeights[from] -= level.nodeWeights[node];
+                partWeights[best] += level.nodeWeights[node];
+                assignment[node] = best;
+                ++moves;
+            }
+        }
+        if (moves == 0)
+        {
+            break;
+        }
+    }
+}
+
+// k-way Fiduccia-Mattheyses pass: the unlocked boundary node with the highest gain moves even when the
+// gain is negative, and is then locked for the pass; at the end the moves after the lowest cut seen are
+// undone. Sequences of moves can thus cross the zero-gain plateaus where greedy refinement stops, as on
+// grids. Passes stop after `stallLimit` moves without a new lowest cut, and repeat while the cut drops.
+void improve(Level const& level, std::vector<uint32_t>& assignment, uint32_t parts, uint64_t maxPartWeight, std::mt19937_64& random)
+{
+    node_type size = level.size();
+    std::vector<uint64_t> partWeights(parts, 0);
+    for (node_type node = 0; node < size; ++node)
+    {
+        partWeights[assignment[node]] += level.nodeWeights[node];
+    }
+    std::vector<uint64_t> connection(parts, 0);
+    std::vector<uint32_t> touched;
+    touched.reserve(parts);
+    constexpr int64_t noMove = std::numeric_limits<int64_t>::min();
+    // Gain of the best move of `node` to a neighbouring part with room for it, or noMove.
+    auto bestMove = [&](node_type node, uint32_t& target)
+    {
+        uint32_t from = assignment[node];
+        for (std::size_t edge = level.offsets[node]; edge < level.offsets[node + 1]; ++edge)
+        {
+            uint32_t part = assignment[level.targets[edge]];
+            if (connection[part] == 0)
+            {
+                touched.push_back(part);
+            }
+            connection[part] += level.edgeWeights[edge];
+        }
+        int64_t bestGain = noMove;
+        for (uint32_t part : touched)
+        {
+            if (part == from || partWeights[part] + level.nodeWeights[node] > maxPartWeight)
+            {
+                continue;
+            }
+            int64_t gain = static_cast<int64_t>(connection[part]) - static_cast<int64_t>(connection[from]);
+            if (gain > bestGain || (gain == bestGain && partWeights[part] < partWeights[target]))
+            {
+                bestGain = gain;
+                target = part;
+            }
+        }
+        for (uint32_t part : touched)
+        {
+            connection[part] = 0;
+        }
+        touched.clear();
+        return bestGain;
+    };
+
+    // Max-heap on gain; the random key spreads ties over the boundary instead of following node ids.
+    struct Candidate
+    {
+        int64_t gain;
+        uint64_t tie;
+        node_type node;
+
+        bool operator<(Candidate const& other) const
+        {
+            return gain < other.gain || (gain == other.gain && tie < other.tie);
+        }
+    };
+    std::vector<Candidate> heap;
+    // Key of each node's live heap entry; entries with another key are outdated and skipped.
+    std::vector<int64_t> keys(size, noMove);
+    std::vector<uint8_t> locked(size, 0);
+    std::vector<std::pair<node_type, uint32_t>> moves;
+    std::size_t stallLimit = std::max<std::size_t>(size / 40, 128);
+    auto push = [&](node_type node, int64_t key)
+    {
+        keys[node] = key;
+        if (key != noMove)
+        {
+            heap.push_back(Candidate{key, random(), node});
+            std::push_heap(heap.begin(), heap.end());
+        }
+    };
+
+    for (int pass = 0; pass < 8; ++pass)
+    {
+        heap.clear();
+        moves.clear();
+        std::fill(locked.begin(), locked.end(), 0);
+        for (node_type node = 0; node < size; ++node)
+        {
+            uint32_t target = assignment[node];
+            push(node, bestMove(node, target));
+        }
+        int64_t cutChange = 0;
+        int64_t bestChange = 0;
+        std::size_t bestMoves = 0;
+        while (!heap.empty() && moves.size() - bestMoves < stallLimit)
+        {
+            Candidate candidate = heap.front();
+            std::pop_heap(heap.begin(), heap.end());
+            heap.pop_back();
+            node_type node = candidate.node;
+            if (locked[node] != 0 || keys[node] != candidate.gain)
+            {
+                continue;
+            }
+            uint32_t target = assignment[node];
+            int64_t gain = bestMove(node, target);
+            if (gain != candidate.gain)
+            {
+                // The key was only a bound, or a part has filled up since; requeue with the exact gain.
+                push(node, gain);
+                continue;
+            }
+            uint32_t from = assignment[node];
+            partWeights[from] -= level.nodeWeights[node];
+            partWeights[target] += level.nodeWeights[node];
+            assignment[node] = target;
+            locked[node] = 1;
+            moves.emplace_back(node, from);
+            cutChange -= gain;
+            if (cutChange < bestChange)
+            {
+                bestChange = cutChange;
+                bestMoves = moves.size();
+            }
+            // Moving `node` raises a neighbour's gain by at most twice their edge weight, so neighbours are
+            // requeued with that bound and only evaluated when they reach the top; hubs are not rescanned
+            // for every neighbour that moves.
+            for (std::size_t edge = level.offsets[node]; edge < level.offsets[node + 1]; ++edge)
+            {
+                node_type neighbour = level.targets[edge];
+                if (locked[neighbour] != 0)
+                {
+                    continue;
+                }
+                else if (keys[neighbour] == noMove)
+                {
+                    uint32_t neighbourTarget = assignment[neighbour];
+                    push(neighbour, bestMove(neighbour, neighbourTarget));
+                }
+                else
+                {
+                    push(neighbour, keys[neighbour] + 2 * static_cast<int64_t>(level.edgeWeights[edge]));
+                }
+            }
+        }
+        while (moves.size() > bestMoves)
+        {
+            node_type node = moves.back().first;
+            partWeights[assignment[node]] -= level.nodeWeights[node];
+            partWeights[moves.back().second] += level.nodeWeights[node];
+            assignment[node] = moves.back().second;
+            moves.pop_back();
+        }
+        if (bestChange == 0)
+        {
+            break;
+        }
+    }
+}
+
+uint64_t cutWeight(Level const& level, std::vector<uint32_t> const& assignment)
+{
+    uint64_t cut = 0;
+    for (node_type node = 0; node < level.size(); ++node)
+    {
+        for (std::size_t edge = level.offsets[node]; edge < level.offsets[node + 1]; ++edge)
+        {
+            if (assignment[level.targets[edge]] != assignment[node])
+            {
+                cut += level.edgeWeights[edge];
+            }
+        }
+    }
+    return cut / 2;
+}
+
+std::vector<uint32_t> multilevel(AdjacencyList const& undirected, uint32_t parts, uint64_t maxPartWeight, uint64_t seed)
+{
+    std::mt19937_64 random(seed);
+    std::vector<Level> levels;
+    levels.push_back(fromAdjacency(undirected));
+    node_type coarsestSize = std::max<node_type>(parts * 16, 128);
+    // A coarse node heavier than a fraction of a part would make balancing impossible.
+    uint64_t maxNodeWeight = std::max<uint64_t>(maxPartWeight / 4, 1);
+    while (levels.back().size() > coarsestSize)
+    {
+        Level coarse = coarsen(levels.back(), maxNodeWeight, random);
+        if (coarse.size() * 10 > levels.back().size() * 9)
+        {
+            break;
+        }
+        levels.push_back(std::move(coarse));
+    }
+
+    // The coarsest graph is usually small, so many region-growing starts are cheap; keep the lowest cut.
+    // Coarsening stalls early on graphs dominated by hubs, and then a few starts have to do.
+    int attempts = levels.back().size() <= coarsestSize ? 32 : 4;
+    std::vector<uint32_t> assignment;
+    uint64_t bestCut = std::numeric_limits<uint64_t>::max();
+    for (int attempt = 0; attempt < attempts; ++attempt)
+    {
+        std::vector<uint32_t> candidate = initialPartition(levels.back(), parts, random);
+        refine(levels.back(), candidate, parts, maxPartWeight, random);
+        improve(levels.back(), candidate, parts, maxPartWeight, random);
+        uint64_t cut = cutWeight(levels.back(), candidate);
+        if (cut < bestCut)
+        {
+            bestCut = cut;
+            assignment = std::move(candidate);
+        }
+    }
+    for (std::size_t index = levels.size() - 1; index > 0; --index)
+    {
+        Level const& coarse = levels[index];
+        std::vector<uint32_t> projected(levels[index - 1].size());
+        for (node_type node = 0; node < projected.size(); ++node)
+        {
+            projected[node] = assignment[coarse.fineToCoarse[node]];
+        }
+        assignment = std::move(projected);
+        refine(levels[index - 1], assignment, parts, maxPartWeight, random);
+        improve(levels[index - 1], assignment, parts, maxPartWeight, random);
+    }
+    return assignment;
+}
+
+std::vector<uint32_t> streaming(AdjacencyList const& undirected, uint32_t parts, uint64_t capacity)
+{
+    node_type size = undirected.getSize();
+    constexpr uint32_t unassigned = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> assignment(size, unassigned);
+    std::vector<uint64_t> partSizes(parts, 0);
+    std::vector<uint64_t> neighbours(parts, 0);
+    for (node_type node = 0; node < size; ++node)
+    {
+        for (auto target = undirected.targetsBegin(node); target != undirected.targetsEnd(node); ++target)
+        {
+            if (assignment[*target] != unassigned)
+            {
+                ++neighbours[assignment[*target]];
+            }
+        }
+        uint32_t best = unassigned;
+        double bestScore = -1;
+        for (uint32_t part = 0; part < parts; ++part)
+        {
+            if (partSizes[part] >= capacity)
+            {
+                continue;
+            }
+            double score = static_cast<double>(neighbours[part]) * (1.0 - static_cast<double>(partSizes[part]) / static_cast<double>(capacity));
+            if (score > bestScore || (score == bestScore && partSizes[part] < partSizes[best]))
+            {
+                best = part;
+                bestScore = score;
+            }
+        }
+        std::fill(neighbours.begin(), neighbours.end(), 0);
+        assignment[node] = best;
+        ++partSizes[best];
+    }
+    return assignment;
+}
+
+}
+
+Partitioning partitionGraph(Graph const& graph, uint32_t parts, PartitioningMethod method, double imbalance, uint64_t seed) noexcept(false)
+{
+    if (parts == 0)
+    {
+        throw std::invalid_argument("At least one part is required");
+    }
+    else if (imbalance < 0)
+    {
+        throw std::invalid_argument("Imbalance must not be negative");
+    }
+    AdjacencyList undirected = AdjacencyList{graph}.symmetrized();
+    node_type size = undirected.getSize();
+    uint64_t capacity = std::max<uint64_t>(static_cast<uint64_t>(std::ceil(static_cast<double>(size) / parts * (1.0 + imbalance))), 1);
+
+    Partitioning partitioning;
+    partitioning.assignment = method == PartitioningMethod::Streaming ? streaming(undirected, parts, capacity)
+                                                                       : multilevel(undirected, parts, capacity, seed);
+    partitioning.partSizes.assign(parts, 0);
+    partitioning.edgeCut = 0;
+    for (node_type node = 0; node < size; ++node)
+    {
+        ++partitioning.partSizes[partitioning.assignment[node]];
+        for (auto target = undirected.targetsBegin(node); target != undirected.targetsEnd(node); ++target)
+        {
+            if (*target > node && partitioning.assignment[*target] != partitioning.assignment[node])
+            {
+                ++partitioning.edgeCut;
+            }
+        }
+    }
+    uint32_t largest = *std::max_element(partitioning.partSizes.begin(), partitioning.partSizes.end());
+    partitioning.balance = size == 0 ? 1.0 : static_cast<double>(largest) * parts / size;
+    return partitioning;
+}
+
+Partitioning partitionGraph(LabeledGraph const& graph, uint32_t parts, PartitioningMethod method, double imbalance, uint64_t seed) noexcept(false)
+{
+    return partitionGraph(graph.getRawGraph(), parts, method, imbalance, seed);
+}
+
+std::vector<GraphPartition> extractPartitions(Graph const& graph, Partitioning const& partitioning, unsigned threads) noexcept(false)
+{
+    AdjacencyList adjacency{graph};
+    AdjacencyList undirected = adjacency.symmetrized();
+    node_type size = adjacency.getSize();
+    if (partitioning.assignment.size() != size)
+    {
+        throw std::invalid_argument("The partitioning does not belong to this graph");
+    }
+    uint32_t parts = static_cast<uint32_t>(partitioning.partSizes.size());
+    std::vector<std::vector<node_type>> owned(parts);
+    std::vector<node_type> ownedIndex(size);
+    for (node_type node = 0; node < size; ++node)
+    {
+        uint32_t part = partitioning.assignment[node];
+        if (part >= parts)
+        {
+            throw std::invalid_argument("The partitioning assigns a node to a non-existing part");
+        }
+        ownedIndex[node] = static_cast<node_type>(owned[part].size());
+        owned[part].push_back(node);
+    }
+
+    std::vector<GraphPartition> partitions(parts);
+    Parallel::forEach(parts, threads, [&](unsigned, std::size_t index)
+    {
+        uint32_t part = static_cast<uint32_t>(index);
+        GraphPartition& partition = partitions[part];
+        partition.ownedCount = static_cast<uint32_t>(owned[part].size());
+        partition.localToGlobal = owned[part];
+
+        // Ghosts follow the owned nodes in increasing global id; their local ids are found by binary search.
+        std::vector<std::pair<node_type, node_type>> ghosts;
+        for (node_type node : owned[part])
+        {
+            for (auto target = adjacency.targetsBegin(node); target != adjacency.targetsEnd(node); ++target)
+            {
+                if (partitioning.assignment[*target] != part)
+                {
+                    ghosts.emplace_back(*target, 0);
+                }
+            }
+        }
+        std::sort(ghosts.begin(), ghosts.end());
+        ghosts.erase(std::unique(ghosts.begin(), ghosts.end()), ghosts.end());
+        for (auto&& ghost : ghosts)
+        {
+            ghost.second = static_cast<node_type>(partition.localToGlobal.size());
+            partition.localToGlobal.push_back(ghost.first);
+            partition.ghostOwners.push_back(partitioning.assignment[ghost.first]);
+        }
+        auto localId = [&](node_type global)
+        {
+            if (partitioning.assignment[global] == part)
+            {
+                return ownedIndex[global];
+            }
+            return std::lower_bound(ghosts.begin(), ghosts.end(), std::make_pair(global, node_type{0}))->second;
+        };
+
+        partition.subgraph = Graph{static_cast<uint32_t>(partition.localToGlobal.size()), GraphRepresentation::Sparse};
+        for (node_type local = 0; local < partition.ownedCount; ++local)
+        {
+            node_type node = owned[part][local];
+            edge_weight_type const* weight = adjacency.weightsBegin(node);
+            for (auto target = adjacency.targetsBegin(node); target != adjacency.targetsEnd(node); ++target, ++weight)
+            {
+                partition.subgraph.insertEdge(local, localId(*target), *weight, EdgeDirection::Directed);
+            }
+            if (std::any_of(undirected.targetsBegin(node), undirected.targetsEnd(node),
+                            [&](node_type target) { return partitioning.assignment[target] != part; }))
+            {
+                partition.boundary.push_back(local);
+            }
+        }
+        partition.subgraph.optimizeRepresentation();
+    }, 1);
+    return partitions;
+}
+
+}
+
+}
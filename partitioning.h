@@ -0,0 +1,66 @@
+#ifndef PARTITIONING_H
+#define PARTITIONING_H
+
+#include <vector>
+#include "commontypes.hpp"
+#include "graph.h"
+
+namespace Graphs
+{
+
+// Forward declaration of LabeledGraph class
+class LabeledGraph;
+
+namespace Algorithms
+{
+
+enum class PartitioningMethod : uint8_t
+{
+    // Heavy-edge matching coarsening, region-growing initial split, then greedy boundary refinement and
+    // k-way Fiduccia-Mattheyses passes with rollback while projecting back (METIS-style). Several passes
+    // over the graph. Usually lower cuts than Streaming, except when the node ids already follow the
+    // geometry, as on a row-major grid cut in two, where the single streaming pass is nearly straight.
+    Multilevel,
+    // Linear deterministic greedy: one pass in id order, each node joins the part holding most of its
+    // already placed neighbours, damped by how full that part is.
+    Streaming
+};
+
+// Edges are taken as undirected for partitioning; edgeCut counts node pairs connected in either direction
+// whose endpoints ended up in different parts. balance is the largest part over the ideal size n / k.
+struct Partitioning
+{
+    std::vector<uint32_t> assignment;
+    std::vector<uint32_t> partSizes;
+    uint64_t edgeCut;
+    double balance;
+};
+
+// One part as a standalone graph. Owned nodes take local ids [0, ownedCount) in increasing global id
+// order; ghosts, the out-neighbours of owned nodes living in other parts, follow in the same order.
+// Only edges leaving owned nodes are stored, so every edge of the original graph belongs to exactly one
+// part.
+struct GraphPartition
+{
+    Graph subgraph;
+    uint32_t ownedCount;
+    std::vector<Node::integral_type> localToGlobal;
+    // Part owning each ghost, indexed by local id - ownedCount.
+    std::vector<uint32_t> ghostOwners;
+    // Local ids of owned nodes adjacent, in either direction, to a node of another part.
+    std::vector<Node::integral_type> boundary;
+};
+
+// Splits the graph into `parts` parts of at most ceil(n / parts * (1 + imbalance)) nodes each.
+Partitioning partitionGraph(Graph const& graph, uint32_t parts, PartitioningMethod method = PartitioningMethod::Multilevel,
+                            double imbalance = 0.03, uint64_t seed = 1) noexcept(false);
+Partitioning partitionGraph(LabeledGraph const& graph, uint32_t parts, PartitioningMethod method = PartitioningMethod::Multilevel,
+                            double imbalance = 0.03, uint64_t seed = 1) noexcept(false);
+
+std::vector<GraphPartition> extractPartitions(Graph const& graph, Partitioning const& partitioning, unsigned threads = 0) noexcept(false);
+
+}
+
+}
+
+#endif // PARTITIONING_H
@@ -0,0 +1,250 @@
+#include "pathcache.h"
+#include "algorithms.h"
+#include "graph.h"
+#include "labeledgraph.h"
+
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Graphs
+{
+
+namespace
+{
+
+enum QueryKind : uint8_t
+{
+    ShortestPathKind,
+    ReachabilityKind
+};
+
+struct CacheKey
+{
+    uint64_t version;
+    uint64_t nodes;
+    uint8_t kind;
+};
+
+bool operator==(CacheKey const& lhs, CacheKey const& rhs) noexcept
+{
+    return lhs.version == rhs.version && lhs.nodes == rhs.nodes && lhs.kind == rhs.kind;
+}
+
+struct CacheKeyHash
+{
+    std::size_t operator()(CacheKey const& key) const noexcept
+    {
+        uint64_t hash = key.version * 0x9E3779B97F4A7C15ULL ^ key.nodes * 0xC2B2AE3D27D4EB4FULL ^ key.kind;
+        hash ^= hash >> 29;
+        hash *= 0xBF58476D1CE4E5B9ULL;
+        return static_cast<std::size_t>(hash ^ (hash >> 32));
+    }
+};
+
+}
+
+// CLOCK replacement: a hit sets the reference bit, the hand clears bits until it finds an unreferenced slot.
+struct PathCache::Shard
+{
+    struct Slot
+    {
+        CacheKey key;
+        Graph const* graph;
+        int64_t value;
+        bool referenced;
+    };
+
+    struct GraphEntries
+    {
+        uint64_t newestVersion;
+        std::size_t slots;
+    };
+
+    std::mutex mutex;
+    std::vector<Slot> slots;
+    std::unordered_map<CacheKey, std::size_t, CacheKeyHash> index;
+    // Per graph with entries in this shard; a graph's address may be reused, but never its versions.
+    std::unordered_map<Graph const*, GraphEntries> graphs;
+    std::size_t capacity;
+    std::size_t hand;
+
+    explicit Shard(std::size_t _capacity) : mutex(), slots(), index(), graphs(), capacity(std::max<std::size_t>(_capacity, 1)), hand(0)
+    {
+        slots.reserve(capacity);
+        index.reserve(capacity);
+    }
+
+    bool find(CacheKey const& key, int64_t& value)
+    {
+        auto it = index.find(key);
+        if (it == index.end())
+        {
+            return false;
+        }
+        slots[it->second].referenced = true;
+        value = slots[it->second].value;
+        return true;
+    }
+
+    // Versions only grow, so an entry older than its graph's newest one can never be hit again.
+    bool isOutdated(Slot const& slot) const
+    {
+        return slot.key.version < graphs.at(slot.graph).newestVersion;
+    }
+
+    void track(Graph const* graph, uint64_t version)
+    {
+        GraphEntries& entries = graphs.emplace(graph, GraphEntries{version, 0}).first->second;
+        entries.newestVersion = std::max(entries.newestVersion, version);
+        ++entries.slots;
+    }
+
+    void untrack(Graph const* graph)
+    {
+        auto it = graphs.find(graph);
+        if (--it->second.slots == 0)
+        {
+            graphs.erase(it);
+        }
+    }
+
+    // Returns true when an older entry had to be evicted.
+    bool insert(Graph const* graph, CacheKey const& key, int64_t value)
+    {
+        if (index.find(key) != index.end())
+        {
+            return false;
+        }
+        track(graph, key.version);
+        if (slots.size() < capacity)
+        {
+            index.emplace(key, slots.size());
+            slots.push_back(Slot{key, graph, value, false});
+            return false;
+        }
+        // Outdated entries are dead weight, so they get no second chance.
+        while (slots[hand].referenced && !isOutdated(slots[hand]))
+        {
+            slots[hand].referenced = false;
+            hand = (hand + 1) % capacity;
+        }
+        index.erase(slots[hand].key);
+        untrack(slots[hand].graph);
+        slots[hand] = Slot{key, graph, value, false};
+        index.emplace(key, hand);
+        hand = (hand + 1) % capacity;
+        return true;
+    }
+};
+
+PathCache::PathCache(std::size_t capacity, unsigned shards) : m_shards(), m_hits(0), m_misses(0), m_evictions(0)
+{
+    shards = std::max(shards, 1U);
+    for (unsigned shard = 0; shard < shards; ++shard)
+    {
+        m_shards.emplace_back(new Shard((capacity + shards - 1) / shards));
+    }
+}
+
+PathCache::~PathCache() = default;
+
+template <typename Compute>
+int64_t PathCache::lookup(Graph const& graph, uint8_t kind, Node::integral_type root, Node::integral_type target, Compute&& compute)
+{
+    CacheKey key{graph.getVersion(), (static_cast<uint64_t>(root) << 32) | target, kind};
+    Shard& shard = *m_shards[CacheKeyHash()(key) % m_shards.size()];
+    int64_t value = 0;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.find(key, value))
+        {
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            return value;
+        }
+    }
+    // Computed outside the lock; concurrent misses on the same key just race to insert the same value.
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+    value = compute();
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.insert(&graph, key, value))
+    {
+        m_evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+    return value;
+}
+
+int32_t PathCache::findShortestPath(Graph const& graph, Node const& root, Node const& target) noexcept(false)
+{
+    return static_cast<int32_t>(lookup(graph, ShortestPathKind, root.id, target.id, [&]()
+    {
+        return static_cast<int64_t>(Algorithms::findShortestPath(graph, root, target));
+    }));
+}
+
+int32_t PathCache::findShortestPath(LabeledGraph const& graph, LabeledNode const& root, LabeledNode const& target) noexcept(false)
+{
+    return findShortestPath(graph.getRawGraph(), root.node, target.node);
+}
+
+int32_t PathCache::findShortestPath(LabeledGraph const& graph, std::string const& root, std::string const& target) noexcept(false)
+{
+    return findShortestPath(graph.getRawGraph(), graph.getNode(root).node, graph.getNode(target).node);
+}
+
+bool PathCache::isReachable(Graph const& graph, Node const& root, Node const& target) noexcept(false)
+{
+    return lookup(graph, ReachabilityKind, root.id, target.id, [&]()
+    {
+        return static_cast<int64_t>(Algorithms::breadthFirstSearch(graph, root, target) ? 1 : 0);
+    }) != 0;
+}
+
+bool PathCache::isReachable(LabeledGraph const& graph, LabeledNode const& root, LabeledNode const& target) noexcept(false)
+{
+    return isReachable(graph.getRawGraph(), root.node, target.node);
+}
+
+bool PathCache::isReachable(LabeledGraph const& graph, std::string const& root, std::string const& target) noexcept(false)
+{
+    return isReachable(graph.getRawGraph(), graph.getNode(root).node, graph.getNode(target).node);
+}
+
+void PathCache::clear() noexcept
+{
+    for (auto&& shard : m_shards)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->slots.clear();
+        shard->index.clear();
+        shard->graphs.clear();
+        shard->hand = 0;
+    }
+}
+
+std::size_t PathCache::getSize() const noexcept
+{
+    std::size_t size = 0;
+    for (auto&& shard : m_shards)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        size += shard->slots.size();
+    }
+    return size;
+}
+
+CacheStatistics PathCache::getStatistics() const noexcept
+{
+    return CacheStatistics{m_hits.load(std::memory_order_relaxed), m_misses.load(std::memory_order_relaxed),
+                           m_evictions.load(std::memory_order_relaxed)};
+}
+
+void PathCache::resetStatistics() noexcept
+{
+    m_hits.store(0, std::memory_order_relaxed);
+    m_misses.store(0, std::memory_order_relaxed);
+    m_evictions.store(0, std::memory_order_relaxed);
+}
+
+}
@@ -0,0 +1,70 @@
+#ifndef PATHCACHE_H
+#define PATHCACHE_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "commontypes.hpp"
+
+namespace Graphs
+{
+
+// Forward declaration of Graph class
+class Graph;
+// Forward declaration of LabeledGraph class
+class LabeledGraph;
+
+struct CacheStatistics
+{
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+};
+
+// Bounded memo in front of Algorithms::findShortestPath and Algorithms::breadthFirstSearch.
+// Entries are keyed by (graph version, query kind, root, target). Every insertEdge() gives the graph
+// a new process-wide unique version, so results computed before a mutation can never be returned
+// afterwards. Several graphs can share one cache: each shard remembers the newest version it has
+// stored for every graph, and the CLOCK hand evicts entries of an older version of the same graph as
+// soon as it reaches them, whatever their reference bit. Entries of other graphs keep their second chance.
+// The cache is split into independently locked shards, selected by key hash.
+class PathCache
+{
+private:
+    struct Shard;
+
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    std::atomic<uint64_t> m_hits;
+    std::atomic<uint64_t> m_misses;
+    std::atomic<uint64_t> m_evictions;
+
+    template <typename Compute>
+    int64_t lookup(Graph const& graph, uint8_t kind, Node::integral_type root, Node::integral_type target, Compute&& compute);
+
+public:
+    explicit PathCache(std::size_t capacity = 1U << 16, unsigned shards = 16);
+    PathCache(PathCache const&) = delete;
+    PathCache(PathCache&&) = delete;
+    PathCache& operator=(PathCache const&) = delete;
+    PathCache& operator=(PathCache&&) = delete;
+    ~PathCache();
+
+    int32_t findShortestPath(Graph const& graph, Node const& root, Node const& target) noexcept(false);
+    int32_t findShortestPath(LabeledGraph const& graph, LabeledNode const& root, LabeledNode const& target) noexcept(false);
+    int32_t findShortestPath(LabeledGraph const& graph, std::string const& root, std::string const& target) noexcept(false);
+
+    bool isReachable(Graph const& graph, Node const& root, Node const& target) noexcept(false);
+    bool isReachable(LabeledGraph const& graph, LabeledNode const& root, LabeledNode const& target) noexcept(false);
+    bool isReachable(LabeledGraph const& graph, std::string const& root, std::string const& target) noexcept(false);
+
+    // Drops every cached result, whichever graph it belongs to.
+    void clear() noexcept;
+
+    std::size_t getSize() const noexcept;
+    CacheStatistics getStatistics() const noexcept;
+    void resetStatistics() noexcept;
+};
+
+}
+
+#endif // PATHCACHE_H
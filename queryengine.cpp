@@ -0,0 +1,204 @@
+#include "queryengine.h"
+#include "graph.h"
+#include "labeledgraph.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include <stdexcept>
+
+namespace Graphs
+{
+
+struct QueryEngine::Scratch
+{
+    std::vector<uint32_t> stamps;
+    std::vector<int64_t> distances;
+    std::vector<Node::integral_type> queue;
+    std::vector<std::pair<int64_t, Node::integral_type>> heap;
+    uint32_t epoch;
+
+    explicit Scratch(uint32_t size) : stamps(size, 0), distances(size, 0), queue(), heap(), epoch(0)
+    {
+        queue.reserve(size);
+    }
+
+    void nextEpoch()
+    {
+        if (++epoch == 0)
+        {
+            std::fill(stamps.begin(), stamps.end(), 0);
+            epoch = 1;
+        }
+    }
+
+    bool seen(Node::integral_type node) const
+    {
+        return stamps[node] == epoch;
+    }
+};
+
+QueryEngine::QueryEngine(Graph const& graph, unsigned threads) : m_adjacency(graph), m_hasNegativeWeights(false), m_scratches(),
+                                                                  m_pool(threads)
+{
+    m_hasNegativeWeights = (m_adjacency.getMinWeight() < 0);
+    for (unsigned worker = 0; worker < m_pool.getSize(); ++worker)
+    {
+        m_scratches.emplace_back(new Scratch(m_adjacency.getSize()));
+    }
+}
+
+QueryEngine::QueryEngine(LabeledGraph const& graph, unsigned threads) : QueryEngine(graph.getRawGraph(), threads) { }
+
+QueryEngine::~QueryEngine() = default;
+
+uint32_t QueryEngine::getSize() const noexcept
+{
+    return m_adjacency.getSize();
+}
+
+unsigned QueryEngine::getThreadsCount() const noexcept
+{
+    return m_pool.getSize();
+}
+
+AdjacencyList const& QueryEngine::getAdjacency() const noexcept
+{
+    return m_adjacency;
+}
+
+int64_t QueryEngine::execute(Query const& query, unsigned worker) const noexcept(false)
+{
+    if (query.source >= getSize() || query.target >= getSize())
+    {
+        throw std::invalid_argument("Root or target node does not exist in the graph");
+    }
+    Scratch& scratch = *m_scratches.at(worker);
+    scratch.nextEpoch();
+    switch (query.type)
+    {
+    case QueryType::Reachability:
+        return reachability(scratch, query.source, query.target);
+    case QueryType::ShortestPath:
+        return shortestPath(scratch, query.source, query.target);
+    case QueryType::Neighbours:
+        return m_adjacency.getDegree(query.source);
+    }
+    throw std::invalid_argument("Unknown query type");
+}
+
+std::future<int64_t> QueryEngine::submit(Query const& query)
+{
+    return m_pool.async([this, query](unsigned worker) { return execute(query, worker); });
+}
+
+std::vector<std::future<int64_t>> QueryEngine::submit(std::vector<Query> const& batch, std::size_t grouping)
+{
+    grouping = std::max<std::size_t>(grouping, 1);
+    std::vector<std::future<int64_t>> futures;
+    futures.reserve(batch.size());
+    for (std::size_t begin = 0; begin < batch.size(); begin += grouping)
+    {
+        std::size_t end = std::min(begin + grouping, batch.size());
+        auto group = std::make_shared<std::vector<std::pair<Query, std::promise<int64_t>>>>();
+        group->reserve(end - begin);
+        for (std::size_t index = begin; index < end; ++index)
+        {
+            group->emplace_back(batch[index], std::promise<int64_t>());
+            futures.push_back(group->back().second.get_future());
+        }
+        m_pool.submit([this, group](unsigned worker)
+        {
+            for (auto&& entry : *group)
+            {
+                try
+                {
+                    entry.second.set_value(execute(entry.first, worker));
+                }
+                catch (...)
+                {
+                    entry.second.set_exception(std::current_exception());
+                }
+            }
+        });
+    }
+    return futures;
+}
+
+// =====================================================
+//                   IMPLEMENTATION
+// =====================================================
+
+int64_t QueryEngine::reachability(Scratch& scratch, Node::integral_type source, Node::integral_type target) const
+{
+    if (source == target)
+    {
+        return 1;
+    }
+    scratch.queue.clear();
+    scratch.queue.push_back(source);
+    scratch.stamps[source] = scratch.epoch;
+    for (std::size_t head = 0; head < scratch.queue.size(); ++head)
+    {
+        Node::integral_type node = scratch.queue[head];
+        for (auto it = m_adjacency.targetsBegin(node); it != m_adjacency.targetsEnd(node); ++it)
+        {
+            if (!scratch.seen(*it))
+            {
+                if (*it == target)
+                {
+                    return 1;
+                }
+                scratch.stamps[*it] = scratch.epoch;
+                scratch.queue.push_back(*it);
+            }
+        }
+    }
+    return 0;
+}
+
+int64_t QueryEngine::shortestPath(Scratch& scratch, Node::integral_type source, Node::integral_type target) const
+{
+    if (m_hasNegativeWeights)
+    {
+        throw std::invalid_argument("Shortest path queries require non-negative edge weights");
+    }
+    // A stamped node has a tentative distance; settled nodes are recognised by a stale heap entry.
+    using entry_type = std::pair<int64_t, Node::integral_type>;
+    std::greater<entry_type> later;
+    scratch.heap.clear();
+    scratch.heap.emplace_back(0, source);
+    scratch.stamps[source] = scratch.epoch;
+    scratch.distances[source] = 0;
+    while (!scratch.heap.empty())
+    {
+        std::pop_heap(scratch.heap.begin(), scratch.heap.end(), later);
+        entry_type top = scratch.heap.back();
+        scratch.heap.pop_back();
+        if (top.first != scratch.distances[top.second])
+        {
+            continue;
+        }
+        if (top.second == target)
+        {
+            return top.first;
+        }
+        edge_weight_type const* weight = m_adjacency.weightsBegin(top.second);
+        for (auto it = m_adjacency.targetsBegin(top.second); it != m_adjacency.targetsEnd(top.second); ++it, ++weight)
+        {
+            int64_t candidate = top.first + *weight;
+            if (!scratch.seen(*it) || candidate < scratch.distances[*it])
+            {
+                scratch.stamps[*it] = scratch.epoch;
+                scratch.distances[*it] = candidate;
+                scratch.heap.emplace_back(candidate, *it);
+                std::push_heap(scratch.heap.begin(), scratch.heap.end(), later);
+            }
+        }
+    }
+    return unreachableDistance;
+}
+
+}
@@ -0,0 +1,74 @@
+#ifndef QUERYENGINE_H
+#define QUERYENGINE_H
+
+#include <future>
+#include <memory>
+#include <vector>
+#include "adjacencylist.h"
+#include "commontypes.hpp"
+#include "threadpool.h"
+
+namespace Graphs
+{
+
+// Forward declaration of Graph class
+class Graph;
+// Forward declaration of LabeledGraph class
+class LabeledGraph;
+
+enum class QueryType : uint8_t
+{
+    Reachability,
+    ShortestPath,
+    Neighbours
+};
+
+struct Query
+{
+    QueryType type;
+    Node::integral_type source;
+    Node::integral_type target;
+};
+
+// In-process query server over an immutable CSR copy of a graph. Queries run on a work-stealing
+// pool; every worker keeps its own visited/distance arrays and invalidates them by bumping an
+// epoch stamp instead of clearing or reallocating, so a query allocates nothing on the hot path.
+// Reachability answers 1 or 0, ShortestPath the distance or unreachableDistance, Neighbours the
+// out-degree of the source (the neighbours themselves are read from getAdjacency()).
+class QueryEngine
+{
+private:
+    struct Scratch;
+
+    AdjacencyList m_adjacency;
+    bool m_hasNegativeWeights;
+    std::vector<std::unique_ptr<Scratch>> m_scratches;
+    ThreadPool m_pool;
+
+    int64_t reachability(Scratch& scratch, Node::integral_type source, Node::integral_type target) const;
+    int64_t shortestPath(Scratch& scratch, Node::integral_type source, Node::integral_type target) const;
+
+public:
+    explicit QueryEngine(Graph const& graph, unsigned threads = 0);
+    explicit QueryEngine(LabeledGraph const& graph, unsigned threads = 0);
+    QueryEngine(QueryEngine const&) = delete;
+    QueryEngine(QueryEngine&&) = delete;
+    QueryEngine& operator=(QueryEngine const&) = delete;
+    QueryEngine& operator=(QueryEngine&&) = delete;
+    ~QueryEngine();
+
+    uint32_t getSize() const noexcept;
+    unsigned getThreadsCount() const noexcept;
+    AdjacencyList const& getAdjacency() const noexcept;
+
+    // Runs on the calling thread with the scratch buffers of `worker`; that worker must not be busy.
+    int64_t execute(Query const& query, unsigned worker) const noexcept(false);
+
+    std::future<int64_t> submit(Query const& query);
+    // Queries are grouped into tasks of `grouping` so that small queries amortize scheduling.
+    std::vector<std::future<int64_t>> submit(std::vector<Query> const& batch, std::size_t grouping = 32);
+};
+
+}
+
+#endif // QUERYENGINE_H
@@ -0,0 +1,458 @@
+#include "queryserver.h"
+
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <stdexcept>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace Graphs
+{
+
+namespace
+{
+
+constexpr std::size_t queryRecordSize = 9;
+
+std::runtime_error socketError(std::string const& what)
+{
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+void put32(std::vector<uint8_t>& out, uint32_t value)
+{
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        out.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+void put64(std::vector<uint8_t>& out, uint64_t value)
+{
+    for (int shift = 0; shift < 64; shift += 8)
+    {
+        out.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+uint32_t get32(uint8_t const* in)
+{
+    return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8)
+            | (static_cast<uint32_t>(in[2]) << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+uint64_t get64(uint8_t const* in)
+{
+    return static_cast<uint64_t>(get32(in)) | (static_cast<uint64_t>(get32(in + 4)) << 32);
+}
+
+// Returns false on orderly shutdown before any byte was read.
+bool readExactly(int fd, uint8_t* data, std::size_t size)
+{
+    std::size_t done = 0;
+    while (done < size)
+    {
+        ssize_t got = ::recv(fd, data + done, size - done, 0);
+        if (got == 0)
+        {
+            if (done == 0)
+            {
+                return false;
+            }
+            throw std::runtime_error("Connection closed in the middle of a frame");
+        }
+        else if (got < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throw socketError("recv failed");
+        }
+        done += static_cast<std::size_t>(got);
+    }
+    return true;
+}
+
+void writeAll(int fd, std::vector<uint8_t> const& data)
+{
+    std::size_t done = 0;
+    while (done < data.size())
+    {
+        ssize_t sent = ::send(fd, data.data() + done, data.size() - done, MSG_NOSIGNAL);
+        if (sent < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throw socketError("send failed");
+        }
+        done += static_cast<std::size_t>(sent);
+    }
+}
+
+bool hasPendingInput(int fd)
+{
+    pollfd descriptor{fd, POLLIN, 0};
+    return ::poll(&descriptor, 1, 0) > 0;
+}
+
+struct PendingFrame
+{
+    std::vector<Query> queries;
+    std::vector<uint8_t> valid;
+    std::vector<std::future<int64_t>> results;
+};
+
+}
+
+QueryServer::QueryServer(QueryEngine& engine) : m_engine(engine), m_listener(-1), m_unixPath(), m_stopping(false), m_connectionsMutex(),
+                                                m_connections(), m_drained()
+{
+}
+
+QueryServer::~QueryServer()
+{
+    stop();
+    {
+        std::unique_lock<std::mutex> lock(m_connectionsMutex);
+        m_drained.wait(lock, [this] { return m_connections.empty(); });
+    }
+    if (m_listener >= 0)
+    {
+        ::close(m_listener);
+    }
+    if (!m_unixPath.empty())
+    {
+        ::unlink(m_unixPath.c_str());
+    }
+}
+
+void QueryServer::listenUnix(std::string const& path) noexcept(false)
+{
+    sockaddr_un address{};
+    if (path.size() >= sizeof(address.sun_path))
+    {
+        throw std::invalid_argument("Unix socket path is too long");
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    m_listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_listener < 0)
+    {
+        throw socketError("socket failed");
+    }
+    ::unlink(path.c_str());
+    if (::bind(m_listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || ::listen(m_listener, SOMAXCONN) < 0)
+    {
+        throw socketError("Could not listen on " + path);
+    }
+    m_unixPath = path;
+}
+
+void QueryServer::listenTcp(uint16_t port) noexcept(false)
+{
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    m_listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (m_listener < 0)
+    {
+        throw socketError("socket failed");
+    }
+    int enable = 1;
+    ::setsockopt(m_listener, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    if (::bind(m_listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || ::listen(m_listener, SOMAXCONN) < 0)
+    {
+        throw socketError("Could not listen on port " + std::to_string(port));
+    }
+}
+
+uint16_t QueryServer::getPort() const noexcept(false)
+{
+    sockaddr_in address{};
+    socklen_t length = sizeof(address);
+    if (::getsockname(m_listener, reinterpret_cast<sockaddr*>(&address), &length) < 0 || address.sin_family != AF_INET)
+    {
+        throw std::runtime_error("The server is not listening on a TCP port");
+    }
+    return ntohs(address.sin_port);
+}
+
+void QueryServer::run() noexcept(false)
+{
+    if (m_listener < 0)
+    {
+        throw std::runtime_error("The server is not listening");
+    }
+    while (!m_stopping.load())
+    {
+        int connection = ::accept(m_listener, nullptr, nullptr);
+        if (connection < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+            {
+                continue;
+            }
+            if (m_stopping.load())
+            {
+                break;
+            }
+            throw socketError("accept failed");
+        }
+        int enable = 1;
+        ::setsockopt(connection, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+        {
+            std::lock_guard<std::mutex> lock(m_connectionsMutex);
+            if (m_stopping.load())
+            {
+                ::close(connection);
+                break;
+            }
+            m_connections.insert(connection);
+        }
+        std::thread(&QueryServer::serveConnection, this, connection).detach();
+    }
+}
+
+void QueryServer::stop() noexcept
+{
+    m_stopping.store(true);
+    if (m_listener >= 0)
+    {
+        ::shutdown(m_listener, SHUT_RDWR);
+    }
+    std::lock_guard<std::mutex> lock(m_connectionsMutex);
+    for (auto&& connection : m_connections)
+    {
+        ::shutdown(connection, SHUT_RDWR);
+    }
+}
+
+void QueryServer::serveConnection(int connection)
+{
+    AdjacencyList const& adjacency = m_engine.getAdjacency();
+    std::deque<PendingFrame> pending;
+    std::vector<uint8_t> input;
+    std::vector<uint8_t> output;
+
+    // Answers the oldest dispatched frame; neighbour lists are copied straight from the CSR arrays.
+    auto answerOldest = [&]()
+    {
+        PendingFrame& frame = pending.front();
+        output.clear();
+        put32(output, static_cast<uint32_t>(frame.queries.size()));
+        for (std::size_t index = 0; index < frame.queries.size(); ++index)
+        {
+            int64_t value = 0;
+            uint8_t status = Protocol::InvalidQuery;
+            if (frame.valid[index] != 0)
+            {
+                try
+                {
+                    value = frame.results[index].get();
+                    status = Protocol::Ok;
+                }
+                catch (std::exception&)
+                {
+                }
+            }
+            output.push_back(status);
+            output.push_back(static_cast<uint8_t>(frame.queries[index].type));
+            put64(output, static_cast<uint64_t>(value));
+            if (status == Protocol::Ok && frame.queries[index].type == QueryType::Neighbours)
+            {
+                Node::integral_type source = frame.queries[index].source;
+                edge_weight_type const* weight = adjacency.weightsBegin(source);
+                for (auto it = adjacency.targetsBegin(source); it != adjacency.targetsEnd(source); ++it, ++weight)
+                {
+                    put32(output, *it);
+                    output.push_back(static_cast<uint8_t>(static_cast<uint16_t>(*weight)));
+                    output.push_back(static_cast<uint8_t>(static_cast<uint16_t>(*weight) >> 8));
+                }
+            }
+        }
+        writeAll(connection, output);
+        pending.pop_front();
+    };
+
+    try
+    {
+        uint8_t header[4];
+        while (readExactly(connection, header, sizeof(header)))
+        {
+            uint32_t count = get32(header);
+            if (count > Protocol::maxQueriesPerFrame)
+            {
+                throw std::runtime_error("Frame is too large");
+            }
+            input.resize(static_cast<std::size_t>(count) * queryRecordSize);
+            if (count != 0 && !readExactly(connection, input.data(), input.size()))
+            {
+                throw std::runtime_error("Connection closed in the middle of a frame");
+            }
+
+            PendingFrame frame;
+            frame.queries.reserve(count);
+            frame.valid.reserve(count);
+            std::vector<Query> dispatched;
+            dispatched.reserve(count);
+            for (uint32_t index = 0; index < count; ++index)
+            {
+                uint8_t const* record = input.data() + index * queryRecordSize;
+                Query query{static_cast<QueryType>(record[0]), get32(record + 1), get32(record + 5)};
+                bool valid = record[0] <= static_cast<uint8_t>(QueryType::Neighbours);
+                frame.queries.push_back(query);
+                frame.valid.push_back(valid ? 1 : 0);
+                if (valid)
+                {
+                    dispatched.push_back(query);
+                }
+            }
+            std::vector<std::future<int64_t>> futures = m_engine.submit(dispatched);
+            auto next = futures.begin();
+            for (std::size_t index = 0; index < frame.queries.size(); ++index)
+            {
+                frame.results.emplace_back(frame.valid[index] != 0 ? std::move(*next++) : std::future<int64_t>());
+            }
+            pending.push_back(std::move(frame));
+
+            // Keep reading while the client has more frames in flight; answer once it is waiting on us.
+            while (!pending.empty() && (!hasPendingInput(connection) || pending.size() > 64))
+            {
+                answerOldest();
+            }
+        }
+        while (!pending.empty())
+        {
+            answerOldest();
+        }
+    }
+    catch (std::exception&)
+    {
+        // A broken or misbehaving client only loses its own connection.
+    }
+
+    // Closed under the lock so stop() never shuts down a descriptor number that was already reused.
+    std::lock_guard<std::mutex> lock(m_connectionsMutex);
+    m_connections.erase(connection);
+    ::close(connection);
+    m_drained.notify_all();
+}
+
+QueryClient::QueryClient() : m_socket(-1), m_buffer() { }
+
+QueryClient::~QueryClient()
+{
+    if (m_socket >= 0)
+    {
+        ::close(m_socket);
+    }
+}
+
+void QueryClient::connectUnix(std::string const& path) noexcept(false)
+{
+    sockaddr_un address{};
+    if (path.size() >= sizeof(address.sun_path))
+    {
+        throw std::invalid_argument("Unix socket path is too long");
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    m_socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_socket < 0 || ::connect(m_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0)
+    {
+        throw socketError("Could not connect to " + path);
+    }
+}
+
+void QueryClient::connectTcp(uint16_t port) noexcept(false)
+{
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    m_socket = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (m_socket < 0 || ::connect(m_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0)
+    {
+        throw socketError("Could not connect to port " + std::to_string(port));
+    }
+    int enable = 1;
+    ::setsockopt(m_socket, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+}
+
+void QueryClient::send(std::vector<Query> const& batch) noexcept(false)
+{
+    if (batch.size() > Protocol::maxQueriesPerFrame)
+    {
+        throw std::invalid_argument("Too many queries in one frame");
+    }
+    m_buffer.clear();
+    put32(m_buffer, static_cast<uint32_t>(batch.size()));
+    for (auto&& query : batch)
+    {
+        m_buffer.push_back(static_cast<uint8_t>(query.type));
+        put32(m_buffer, query.source);
+        put32(m_buffer, query.target);
+    }
+    writeAll(m_socket, m_buffer);
+}
+
+std::vector<QueryResponse> QueryClient::receive() noexcept(false)
+{
+    uint8_t record[10];
+    if (!readExactly(m_socket, record, 4))
+    {
+        throw std::runtime_error("The server closed the connection");
+    }
+    uint32_t count = get32(record);
+    std::vector<QueryResponse> responses;
+    responses.reserve(count);
+    for (uint32_t index = 0; index < count; ++index)
+    {
+        if (!readExactly(m_socket, record, sizeof(record)))
+        {
+            throw std::runtime_error("The server closed the connection");
+        }
+        responses.push_back(QueryResponse{record[0], record[1], static_cast<int64_t>(get64(record + 2)), {}, {}});
+        QueryResponse& response = responses.back();
+        if (response.status == Protocol::Ok && response.type == static_cast<uint8_t>(QueryType::Neighbours))
+        {
+            m_buffer.resize(static_cast<std::size_t>(response.value) * 6);
+            if (!m_buffer.empty() && !readExactly(m_socket, m_buffer.data(), m_buffer.size()))
+            {
+                throw std::runtime_error("The server closed the connection");
+            }
+            response.neighbours.reserve(static_cast<std::size_t>(response.value));
+            response.weights.reserve(static_cast<std::size_t>(response.value));
+            for (std::size_t offset = 0; offset < m_buffer.size(); offset += 6)
+            {
+                response.neighbours.push_back(Node{get32(m_buffer.data() + offset)});
+                response.weights.push_back(static_cast<edge_weight_type>(static_cast<uint16_t>(m_buffer[offset + 4])
+                                                                         | (static_cast<uint16_t>(m_buffer[offset + 5]) << 8)));
+            }
+        }
+    }
+    return responses;
+}
+
+std::vector<QueryResponse> QueryClient::query(std::vector<Query> const& batch) noexcept(false)
+{
+    send(batch);
+    return receive();
+}
+
+}
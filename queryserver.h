@@ -0,0 +1,101 @@
+#ifndef QUERYSERVER_H
+#define QUERYSERVER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+#include "commontypes.hpp"
+#include "queryengine.h"
+
+namespace Graphs
+{
+
+// Binary protocol, all integers little-endian. A client sends frames
+//     uint32 count, count * { uint8 type, uint32 source, uint32 target }
+// and receives one frame per request frame, in order:
+//     uint32 count, count * { uint8 status, uint8 type, int64 value [, value * { uint32 target, int16 weight }] }
+// where the neighbour list follows only successful Neighbours answers. Frames may be pipelined:
+// the server keeps reading and dispatching while earlier frames are still being answered.
+namespace Protocol
+{
+
+constexpr uint32_t maxQueriesPerFrame = 1U << 20;
+
+enum Status : uint8_t
+{
+    Ok = 0,
+    InvalidQuery = 1
+};
+
+}
+
+struct QueryResponse
+{
+    uint8_t status;
+    uint8_t type;
+    int64_t value;
+    std::vector<Node> neighbours;
+    std::vector<edge_weight_type> weights;
+};
+
+class QueryServer
+{
+private:
+    QueryEngine& m_engine;
+    int m_listener;
+    std::string m_unixPath;
+    std::atomic<bool> m_stopping;
+    std::mutex m_connectionsMutex;
+    std::set<int> m_connections;
+    std::condition_variable m_drained;
+
+    void serveConnection(int connection);
+
+public:
+    explicit QueryServer(QueryEngine& engine);
+    QueryServer(QueryServer const&) = delete;
+    QueryServer(QueryServer&&) = delete;
+    QueryServer& operator=(QueryServer const&) = delete;
+    QueryServer& operator=(QueryServer&&) = delete;
+    ~QueryServer();
+
+    void listenUnix(std::string const& path) noexcept(false);
+    // Binds to the loopback interface only; port 0 picks a free port, see getPort().
+    void listenTcp(uint16_t port) noexcept(false);
+    uint16_t getPort() const noexcept(false);
+
+    // Accepts connections until stop() is called from another thread. stop() takes a lock and is not
+    // async-signal-safe, so a signal handler should only wake a thread that calls it.
+    void run() noexcept(false);
+    void stop() noexcept;
+};
+
+class QueryClient
+{
+private:
+    int m_socket;
+    std::vector<uint8_t> m_buffer;
+
+public:
+    QueryClient();
+    QueryClient(QueryClient const&) = delete;
+    QueryClient(QueryClient&&) = delete;
+    QueryClient& operator=(QueryClient const&) = delete;
+    QueryClient& operator=(QueryClient&&) = delete;
+    ~QueryClient();
+
+    void connectUnix(std::string const& path) noexcept(false);
+    void connectTcp(uint16_t port) noexcept(false);
+
+    // send() may be called several times before the matching receive() calls to pipeline frames.
+    void send(std::vector<Query> const& batch) noexcept(false);
+    std::vector<QueryResponse> receive() noexcept(false);
+    std::vector<QueryResponse> query(std::vector<Query> const& batch) noexcept(false);
+};
+
+}
+
+#endif // QUERYSERVER_H
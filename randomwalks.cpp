@@ -0,0 +1,275 @@
+#include "randomwalks.h"
+#include "fileio.h"
+#include "graph.h"
+#include "labeledgraph.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace Graphs
+{
+
+namespace
+{
+
+constexpr char formatMagic[4] = {'G', 'R', 'W', 'K'};
+constexpr uint32_t formatVersion = 1;
+// magic, version, byte order, walk length, nodes, walks
+constexpr std::size_t headerSize = 4 + 4 + 4 + 4 + 4 + 8;
+// Node ids a worker gathers before taking the file lock.
+constexpr std::size_t bufferIds = std::size_t{1} << 18;
+
+// SplitMix64: one addition and a few multiplications per draw, and any 64-bit value is a usable seed.
+class WalkRandom
+{
+private:
+    uint64_t m_state;
+
+public:
+    explicit WalkRandom(uint64_t seed) : m_state{seed} { }
+
+    uint64_t next() noexcept
+    {
+        uint64_t value = (m_state += 0x9E3779B97F4A7C15ULL);
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+        return value ^ (value >> 31);
+    }
+
+    // Uniform in [0, bound) by multiply-shift; the bias is below bound / 2^32.
+    uint32_t below(uint32_t bound) noexcept
+    {
+        return static_cast<uint32_t>(((next() >> 32) * bound) >> 32);
+    }
+
+    float unit() noexcept
+    {
+        return static_cast<float>(next() >> 40) * (1.0F / 16777216.0F);
+    }
+};
+
+uint64_t walkSeed(uint64_t seed, uint64_t walkId) noexcept
+{
+    WalkRandom mixer{seed ^ (walkId * 0xD1B54A32D192ED03ULL)};
+    return mixer.next();
+}
+
+}
+
+RandomWalker::RandomWalker(Graph const& graph, RandomWalkOptions const& options) noexcept(false)
+    : m_adjacency{graph}, m_probabilities(), m_aliases(), m_options{options}, m_maxBias{1.0}
+{
+    if (m_options.walkLength == 0)
+    {
+        throw std::invalid_argument("Walks must contain at least their start node");
+    }
+    else if (!(m_options.returnParameter > 0.0) || !(m_options.inOutParameter > 0.0))
+    {
+        throw std::invalid_argument("node2vec parameters must be positive");
+    }
+    else if (m_options.weighted && m_adjacency.getEdgesCount() != 0 && m_adjacency.getMinWeight() <= 0)
+    {
+        throw std::invalid_argument("Weighted walks require positive edge weights");
+    }
+    m_maxBias = std::max({1.0, 1.0 / m_options.returnParameter, 1.0 / m_options.inOutParameter});
+    if (m_options.weighted && !m_adjacency.hasUniformWeights())
+    {
+        buildAliasTables();
+    }
+}
+
+RandomWalker::RandomWalker(LabeledGraph const& graph, RandomWalkOptions const& options) noexcept(false)
+    : RandomWalker(graph.getRawGraph(), options)
+{
+}
+
+void RandomWalker::buildAliasTables()
+{
+    m_probabilities.resize(m_adjacency.getEdgesCount());
+    m_aliases.resize(m_adjacency.getEdgesCount());
+    std::vector<double> scaled;
+    std::vector<uint32_t> small;
+    std::vector<uint32_t> large;
+    for (Node::integral_type node = 0; node < m_adjacency.getSize(); ++node)
+    {
+        uint32_t degree = m_adjacency.getDegree(node);
+        AdjacencyList::offset_type base = m_adjacency.edgesBegin(node);
+        edge_weight_type const* weights = m_adjacency.weightsBegin(node);
+        double total = 0;
+        for (uint32_t index = 0; index < degree; ++index)
+        {
+            total += weights[index];
+        }
+        scaled.resize(degree);
+        small.clear();
+        large.clear();
+        for (uint32_t index = 0; index < degree; ++index)
+        {
+            // In double: weight * degree overflows 32 bits on hubs with heavy edges.
+            scaled[index] = static_cast<double>(weights[index]) * degree / total;
+            (scaled[index] < 1.0 ? small : large).push_back(index);
+        }
+        while (!small.empty() && !large.empty())
+        {
+            uint32_t less = small.back();
+            uint32_t more = large.back();
+            small.pop_back();
+            m_probabilities[base + less] = static_cast<float>(scaled[less]);
+            m_aliases[base + less] = more;
+            scaled[more] -= 1.0 - scaled[less];
+            if (scaled[more] < 1.0)
+            {
+                large.pop_back();
+                small.push_back(more);
+            }
+        }
+        // Whatever is left is 1 up to rounding.
+        for (uint32_t index : small)
+        {
+            m_probabilities[base + index] = 1.0F;
+            m_aliases[base + index] = index;
+        }
+        for (uint32_t index : large)
+        {
+            m_probabilities[base + index] = 1.0F;
+            m_aliases[base + index] = index;
+        }
+    }
+}
+
+RandomWalkOptions const& RandomWalker::getOptions() const noexcept
+{
+    return m_options;
+}
+
+uint32_t RandomWalker::walk(Node::integral_type start, uint64_t walkId, Node::integral_type* out) const noexcept(false)
+{
+    if (start >= m_adjacency.getSize())
+    {
+        throw std::invalid_argument("Start node does not exist in the graph");
+    }
+    WalkRandom random{walkSeed(m_options.seed, walkId)};
+    bool aliased = !m_aliases.empty();
+    bool firstOrder = m_options.returnParameter == 1.0 && m_options.inOutParameter == 1.0;
+    float returnBias = static_cast<float>(1.0 / m_options.returnParameter / m_maxBias);
+    float neighbourBias = static_cast<float>(1.0 / m_maxBias);
+    float outwardBias = static_cast<float>(1.0 / m_options.inOutParameter / m_maxBias);
+
+    out[0] = start;
+    uint32_t length = 1;
+    while (length < m_options.walkLength)
+    {
+        Node::integral_type current = out[length - 1];
+        uint32_t degree = m_adjacency.getDegree(current);
+        if (degree == 0)
+        {
+            break;
+        }
+        AdjacencyList::offset_type base = m_adjacency.edgesBegin(current);
+        Node::integral_type next;
+        while (true)
+        {
+            uint32_t index = random.below(degree);
+            if (aliased && random.unit() >= m_probabilities[base + index])
+            {
+                index = m_aliases[base + index];
+            }
+            next = m_adjacency.getTarget(base + index);
+            if (firstOrder || length == 1)
+            {
+                break;
+            }
+            // node2vec: rejection against the bias relative to the previous node.
+            Node::integral_type previous = out[length - 2];
+            float bias = outwardBias;
+            if (next == previous)
+            {
+                bias = returnBias;
+            }
+            else if (std::binary_search(m_adjacency.targetsBegin(previous), m_adjacency.targetsEnd(previous), next))
+            {
+                bias = neighbourBias;
+            }
+            if (random.unit() < bias)
+            {
+                break;
+            }
+        }
+        out[length++] = next;
+    }
+    return length;
+}
+
+uint64_t RandomWalker::writeWalks(std::string const& path, unsigned threads) const noexcept(false)
+{
+    uint32_t nodes = m_adjacency.getSize();
+    uint64_t walks = static_cast<uint64_t>(nodes) * m_options.walksPerNode;
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        throw FileIo::error("Could not create", path);
+    }
+    try
+    {
+        uint8_t header[headerSize];
+        std::memcpy(header, formatMagic, 4);
+        std::memcpy(header + 4, &formatVersion, 4);
+        std::memcpy(header + 8, &FileIo::byteOrderMark, 4);
+        std::memcpy(header + 12, &m_options.walkLength, 4);
+        std::memcpy(header + 16, &nodes, 4);
+        std::memcpy(header + 20, &walks, 8);
+        FileIo::writeAll(fd, header, headerSize, path);
+
+        unsigned workers = Parallel::threadsCount(threads);
+        std::mutex fileMutex;
+        std::vector<std::vector<Node::integral_type>> buffers(workers);
+        auto flush = [&](std::vector<Node::integral_type>& buffer)
+        {
+            std::lock_guard<std::mutex> lock(fileMutex);
+            FileIo::writeAll(fd, reinterpret_cast<uint8_t const*>(buffer.data()), buffer.size() * sizeof(Node::integral_type), path);
+            buffer.clear();
+        };
+        Parallel::forEach(walks, workers, [&](unsigned worker, std::size_t walkId)
+        {
+            std::vector<Node::integral_type>& buffer = buffers[worker];
+            if (buffer.capacity() == 0)
+            {
+                buffer.reserve(bufferIds + m_options.walkLength + 1);
+            }
+            // Walk straight into the buffer behind a length slot filled in afterwards.
+            std::size_t slot = buffer.size();
+            buffer.resize(slot + 1 + m_options.walkLength);
+            uint32_t length = walk(static_cast<Node::integral_type>(walkId % nodes), walkId, buffer.data() + slot + 1);
+            buffer[slot] = length;
+            buffer.resize(slot + 1 + length);
+            if (buffer.size() >= bufferIds)
+            {
+                flush(buffer);
+            }
+        }, 64);
+        for (auto&& buffer : buffers)
+        {
+            flush(buffer);
+        }
+    }
+    catch (...)
+    {
+        ::close(fd);
+        throw;
+    }
+    if (::close(fd) != 0)
+    {
+        throw FileIo::error("Could not close", path);
+    }
+    return walks;
+}
+
+}
@@ -0,0 +1,74 @@
+#ifndef RANDOMWALKS_H
+#define RANDOMWALKS_H
+
+#include <string>
+#include <vector>
+#include "adjacencylist.h"
+#include "commontypes.hpp"
+
+namespace Graphs
+{
+
+// Forward declaration of Graph class
+class Graph;
+// Forward declaration of LabeledGraph class
+class LabeledGraph;
+
+struct RandomWalkOptions
+{
+    // Nodes per walk, the start included; walks end early at nodes without outgoing edges.
+    uint32_t walkLength = 80;
+    uint32_t walksPerNode = 10;
+    // Pick the next node in proportion to the edge weight instead of uniformly; weights must then be positive.
+    bool weighted = false;
+    // node2vec return (p) and in-out (q) parameters; p = q = 1 gives first-order walks.
+    double returnParameter = 1.0;
+    double inOutParameter = 1.0;
+    uint64_t seed = 1;
+};
+
+// Random walks over a CSR snapshot of a graph. Weighted steps draw from per-node alias tables built once
+// (Vose), so a step costs O(1) whatever the degree. node2vec walks keep the first-order draw and accept it
+// with probability bias / maxBias, where the bias is 1/p for returning to the previous node, 1 for a node
+// adjacent to it and 1/q otherwise, which avoids the O(sum of squared degrees) per-edge tables.
+// Every walk has its own generator seeded from the options seed and the walk id, so walks do not depend
+// on the number of threads.
+class RandomWalker
+{
+private:
+    AdjacencyList m_adjacency;
+    // Alias table of every row, aligned with the CSR edges: the probability of keeping an edge and the
+    // row-relative index of its alias.
+    std::vector<float> m_probabilities;
+    std::vector<uint32_t> m_aliases;
+    RandomWalkOptions m_options;
+    double m_maxBias;
+
+    void buildAliasTables();
+
+public:
+    explicit RandomWalker(Graph const& graph, RandomWalkOptions const& options = RandomWalkOptions{}) noexcept(false);
+    explicit RandomWalker(LabeledGraph const& graph, RandomWalkOptions const& options = RandomWalkOptions{}) noexcept(false);
+    RandomWalker(RandomWalker const&) = default;
+    RandomWalker(RandomWalker&&) = default;
+    RandomWalker& operator=(RandomWalker const&) = default;
+    RandomWalker& operator=(RandomWalker&&) = default;
+    ~RandomWalker() = default;
+
+    RandomWalkOptions const& getOptions() const noexcept;
+
+    // Writes the walk with the given id from `start` into out, which must hold walkLength nodes, and
+    // returns the number of nodes written.
+    uint32_t walk(Node::integral_type start, uint64_t walkId, Node::integral_type* out) const noexcept(false);
+
+    // Runs walksPerNode walks from every node on `threads` workers and streams them to `path`; returns the
+    // number of walks. The file is a header (magic "GRWK", u32 version, u32 byte order mark 0x01020304,
+    // u32 walk length, u32 node count, u64 walk count) followed by one record per walk: u32 length and that
+    // many u32 node ids, in host byte order. Walk r of node v has id r * nodes + v; records appear in the
+    // order workers finish them.
+    uint64_t writeWalks(std::string const& path, unsigned threads = 0) const noexcept(false);
+};
+
+}
+
+#endif // RANDOMWALKS_H
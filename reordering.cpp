@@ -0,0 +1,371 @@
+#include "reordering.h"
+#include "adjacencylist.h"
+#include "graph.h"
+#include "labeledgraph.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <vector>
+
+#include <stdexcept>
+
+namespace Graphs
+{
+
+namespace Algorithms
+{
+
+namespace
+{
+
+using node_type = Node::integral_type;
+
+std::vector<node_type> reverseCuthillMcKee(AdjacencyList const& undirected);
+std::vector<node_type> degreeDescending(AdjacencyList const& undirected);
+std::vector<node_type> breadthFirst(AdjacencyList const& undirected);
+std::vector<node_type> gorder(AdjacencyList const& undirected);
+void checkPermutation(Permutation const& permutation, uint32_t size);
+
+}
+
+Permutation computeOrdering(Graph const& graph, NodeOrdering ordering) noexcept(false)
+{
+    AdjacencyList undirected = AdjacencyList{graph}.symmetrized();
+    Permutation permutation;
+    switch (ordering)
+    {
+    case NodeOrdering::ReverseCuthillMcKee:
+        permutation.newToOld = reverseCuthillMcKee(undirected);
+        break;
+    case NodeOrdering::DegreeDescending:
+        permutation.newToOld = degreeDescending(undirected);
+        break;
+    case NodeOrdering::BreadthFirst:
+        permutation.newToOld = breadthFirst(undirected);
+        break;
+    case NodeOrdering::Gorder:
+        permutation.newToOld = gorder(undirected);
+        break;
+    }
+    permutation.oldToNew.resize(permutation.newToOld.size());
+    for (node_type position = 0; position < permutation.newToOld.size(); ++position)
+    {
+        permutation.oldToNew[permutation.newToOld[position]] = position;
+    }
+    return permutation;
+}
+
+Permutation computeOrdering(LabeledGraph const& graph, NodeOrdering ordering) noexcept(false)
+{
+    return computeOrdering(graph.getRawGraph(), ordering);
+}
+
+Graph relabel(Graph const& graph, Permutation const& permutation) noexcept(false)
+{
+    checkPermutation(permutation, graph.getSize());
+    AdjacencyList adjacency{graph};
+    // Filled as sparse rows, so memory follows the edge count until a representation is chosen.
+    Graph relabeled{graph.getSize(), GraphRepresentation::Sparse};
+    for (node_type src = 0; src < adjacency.getSize(); ++src)
+    {
+        edge_weight_type const* weight = adjacency.weightsBegin(src);
+        for (auto it = adjacency.targetsBegin(src); it != adjacency.targetsEnd(src); ++it, ++weight)
+        {
+            relabeled.insertEdge(permutation.oldToNew[src], permutation.oldToNew[*it], *weight, EdgeDirection::Directed);
+        }
+    }
+    relabeled.optimizeRepresentation();
+    return relabeled;
+}
+
+LabeledGraph relabel(LabeledGraph const& graph, Permutation const& permutation) noexcept(false)
+{
+    Graph relabeled = relabel(graph.getRawGraph(), permutation);
+    std::vector<std::string> labels(graph.getSize());
+    for (node_type src = 0; src < graph.getSize(); ++src)
+    {
+        labels[permutation.oldToNew[src]] = graph.getLabel(src);
+    }
+    return LabeledGraph{std::move(relabeled), std::move(labels)};
+}
+
+LocalityMetrics measureLocality(Graph const& graph) noexcept(false)
+{
+    Permutation identity;
+    identity.newToOld.resize(graph.getSize());
+    std::iota(identity.newToOld.begin(), identity.newToOld.end(), 0);
+    identity.oldToNew = identity.newToOld;
+    return measureLocality(graph, identity);
+}
+
+LocalityMetrics measureLocality(Graph const& graph, Permutation const& permutation) noexcept(false)
+{
+    checkPermutation(permutation, graph.getSize());
+    AdjacencyList adjacency{graph};
+    LocalityMetrics metrics{0, 0.0, 0.0};
+    for (node_type src = 0; src < adjacency.getSize(); ++src)
+    {
+        int64_t position = permutation.oldToNew[src];
+        for (auto it = adjacency.targetsBegin(src); it != adjacency.targetsEnd(src); ++it)
+        {
+            uint64_t gap = static_cast<uint64_t>(std::llabs(position - static_cast<int64_t>(permutation.oldToNew[*it])));
+            metrics.bandwidth = std::max(metrics.bandwidth, gap);
+            metrics.averageGap += static_cast<double>(gap);
+            metrics.averageLogGap += std::log2(static_cast<double>(gap) + 1.0);
+        }
+    }
+    if (adjacency.getEdgesCount() != 0)
+    {
+        metrics.averageGap /= adjacency.getEdgesCount();
+        metrics.averageLogGap /= adjacency.getEdgesCount();
+    }
+    return metrics;
+}
+
+// =====================================================
+//                   IMPLEMENTATION
+// =====================================================
+
+namespace
+{
+
+void checkPermutation(Permutation const& permutation, uint32_t size)
+{
+    if (permutation.newToOld.size() != size || permutation.oldToNew.size() != size)
+    {
+        throw std::invalid_argument("Permutation does not match the graph size");
+    }
+    for (node_type position = 0; position < size; ++position)
+    {
+        if (permutation.newToOld[position] >= size || permutation.oldToNew[permutation.newToOld[position]] != position)
+        {
+            throw std::invalid_argument("Permutation mappings are not inverse of each other");
+        }
+    }
+}
+
+// Breadth-first layout of one component from `start`, neighbours visited by ascending degree when requested.
+void layoutComponent(AdjacencyList const& undirected, node_type start, bool byDegree, std::vector<uint8_t>& placed,
+                     std::vector<node_type>& order)
+{
+    std::size_t head = order.size();
+    placed[start] = 1;
+    order.push_back(start);
+    std::vector<node_type> neighbours;
+    for (; head < order.size(); ++head)
+    {
+        node_type node = order[head];
+        neighbours.clear();
+        for (auto it = undirected.targetsBegin(node); it != undirected.targetsEnd(node); ++it)
+        {
+            if (placed[*it] == 0)
+            {
+                placed[*it] = 1;
+                neighbours.push_back(*it);
+            }
+        }
+        if (byDegree)
+        {
+            std::stable_sort(neighbours.begin(), neighbours.end(), [&undirected](node_type lhs, node_type rhs)
+            {
+                return undirected.getDegree(lhs) < undirected.getDegree(rhs);
+            });
+        }
+        order.insert(order.end(), neighbours.begin(), neighbours.end());
+    }
+}
+
+// George-Liu heuristic: repeat BFS from the farthest, lowest-degree node while the eccentricity grows.
+node_type pseudoPeripheral(AdjacencyList const& undirected, node_type start, std::vector<uint32_t>& depth, std::vector<node_type>& queue)
+{
+    uint32_t eccentricity = 0;
+    for (int attempt = 0; attempt < 8; ++attempt)
+    {
+        queue.clear();
+        queue.push_back(start);
+        depth[start] = 0;
+        std::size_t head = 0;
+        for (; head < queue.size(); ++head)
+        {
+            node_type node = queue[head];
+            for (auto it = undirected.targetsBegin(node); it != undirected.targetsEnd(node); ++it)
+            {
+                if (depth[*it] == std::numeric_limits<uint32_t>::max())
+                {
+                    depth[*it] = depth[node] + 1;
+                    queue.push_back(*it);
+                }
+            }
+        }
+        uint32_t farthest = depth[queue.back()];
+        node_type candidate = queue.back();
+        for (auto it = queue.rbegin(); it != queue.rend() && depth[*it] == farthest; ++it)
+        {
+            if (undirected.getDegree(*it) < undirected.getDegree(candidate))
+            {
+                candidate = *it;
+            }
+        }
+        for (auto&& node : queue)
+        {
+            depth[node] = std::numeric_limits<uint32_t>::max();
+        }
+        if (farthest <= eccentricity)
+        {
+            break;
+        }
+        eccentricity = farthest;
+        start = candidate;
+    }
+    return start;
+}
+
+std::vector<node_type> reverseCuthillMcKee(AdjacencyList const& undirected)
+{
+    uint32_t size = undirected.getSize();
+    std::vector<node_type> byDegree(size);
+    std::iota(byDegree.begin(), byDegree.end(), 0);
+    std::stable_sort(byDegree.begin(), byDegree.end(), [&undirected](node_type lhs, node_type rhs)
+    {
+        return undirected.getDegree(lhs) < undirected.getDegree(rhs);
+    });
+
+    std::vector<uint8_t> placed(size, 0);
+    std::vector<uint32_t> depth(size, std::numeric_limits<uint32_t>::max());
+    std::vector<node_type> queue;
+    std::vector<node_type> order;
+    order.reserve(size);
+    for (auto&& node : byDegree)
+    {
+        if (placed[node] == 0)
+        {
+            layoutComponent(undirected, pseudoPeripheral(undirected, node, depth, queue), true, placed, order);
+        }
+    }
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+std::vector<node_type> degreeDescending(AdjacencyList const& undirected)
+{
+    std::vector<node_type> order(undirected.getSize());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&undirected](node_type lhs, node_type rhs)
+    {
+        return undirected.getDegree(lhs) > undirected.getDegree(rhs);
+    });
+    return order;
+}
+
+std::vector<node_type> breadthFirst(AdjacencyList const& undirected)
+{
+    uint32_t size = undirected.getSize();
+    std::vector<uint8_t> placed(size, 0);
+    std::vector<node_type> order;
+    order.reserve(size);
+    for (node_type node = 0; node < size; ++node)
+    {
+        if (placed[node] == 0)
+        {
+            layoutComponent(undirected, node, false, placed, order);
+        }
+    }
+    return order;
+}
+
+// Greedy Gorder: the next node is the one sharing the most neighbours and edges with the last
+// `window` placed nodes. Scores are updated as nodes enter and leave the window and kept in a lazy
+// max-heap. Sibling updates skip hubs, as in the original paper, to bound the quadratic fan-out.
+std::vector<node_type> gorder(AdjacencyList const& undirected)
+{
+    constexpr std::size_t window = 5;
+    uint32_t size = undirected.getSize();
+    uint32_t hubDegree = std::max<uint32_t>(64, static_cast<uint32_t>(std::sqrt(static_cast<double>(size))));
+    std::vector<int64_t> scores(size, 0);
+    std::vector<uint8_t> placed(size, 0);
+    std::priority_queue<std::pair<int64_t, node_type>> heap;
+    std::vector<node_type> byDegree = degreeDescending(undirected);
+    std::size_t nextSeed = 0;
+
+    auto update = [&](node_type node, int64_t change)
+    {
+        auto bump = [&](node_type other)
+        {
+            if (placed[other] == 0)
+            {
+                scores[other] += change;
+                if (change > 0)
+                {
+                    heap.emplace(scores[other], other);
+                }
+            }
+        };
+        for (auto it = undirected.targetsBegin(node); it != undirected.targetsEnd(node); ++it)
+        {
+            bump(*it);
+            if (undirected.getDegree(*it) <= hubDegree)
+            {
+                for (auto sibling = undirected.targetsBegin(*it); sibling != undirected.targetsEnd(*it); ++sibling)
+                {
+                    if (*sibling != node)
+                    {
+                        bump(*sibling);
+                    }
+                }
+            }
+        }
+    };
+
+    std::vector<node_type> order;
+    order.reserve(size);
+    while (order.size() < size)
+    {
+        node_type next = size;
+        while (!heap.empty())
+        {
+            std::pair<int64_t, node_type> top = heap.top();
+            heap.pop();
+            if (placed[top.second] != 0)
+            {
+                continue;
+            }
+            if (top.first != scores[top.second])
+            {
+                if (scores[top.second] > 0)
+                {
+                    heap.emplace(scores[top.second], top.second);
+                }
+                continue;
+            }
+            next = top.second;
+            break;
+        }
+        if (next == size)
+        {
+            while (placed[byDegree[nextSeed]] != 0)
+            {
+                ++nextSeed;
+            }
+            next = byDegree[nextSeed];
+        }
+
+        placed[next] = 1;
+        order.push_back(next);
+        update(next, 1);
+        if (order.size() > window)
+        {
+            update(order[order.size() - window - 1], -1);
+        }
+    }
+    return order;
+}
+
+}
+
+}
+
+}
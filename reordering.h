@@ -0,0 +1,54 @@
+#ifndef REORDERING_H
+#define REORDERING_H
+
+#include <vector>
+#include "commontypes.hpp"
+
+namespace Graphs
+{
+
+// Forward declaration of Graph class
+class Graph;
+// Forward declaration of LabeledGraph class
+class LabeledGraph;
+
+namespace Algorithms
+{
+
+enum class NodeOrdering : uint8_t
+{
+    ReverseCuthillMcKee,
+    DegreeDescending,
+    BreadthFirst,
+    Gorder
+};
+
+// newToOld[i] is the old id placed at position i, oldToNew is its inverse.
+struct Permutation
+{
+    std::vector<Node::integral_type> newToOld;
+    std::vector<Node::integral_type> oldToNew;
+};
+
+// Id distance between edge endpoints: the largest one (matrix bandwidth), the mean and the mean of log2(gap + 1).
+struct LocalityMetrics
+{
+    uint64_t bandwidth;
+    double averageGap;
+    double averageLogGap;
+};
+
+Permutation computeOrdering(Graph const& graph, NodeOrdering ordering) noexcept(false);
+Permutation computeOrdering(LabeledGraph const& graph, NodeOrdering ordering) noexcept(false);
+
+Graph relabel(Graph const& graph, Permutation const& permutation) noexcept(false);
+LabeledGraph relabel(LabeledGraph const& graph, Permutation const& permutation) noexcept(false);
+
+LocalityMetrics measureLocality(Graph const& graph) noexcept(false);
+LocalityMetrics measureLocality(Graph const& graph, Permutation const& permutation) noexcept(false);
+
+}
+
+}
+
+#endif // REORDERING_H
@@ -0,0 +1,294 @@
+#include "spanningtree.h"
+#include "adjacencylist.h"
+#include "disjointsets.h"
+#include "graph.h"
+#include "labeledgraph.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <vector>
+
+namespace Graphs
+{
+
+namespace Algorithms
+{
+
+namespace
+{
+
+using node_type = Node::integral_type;
+
+struct WeightedEdge
+{
+    node_type first;
+    node_type second;
+    edge_weight_type weight;
+};
+
+}
+
+static std::vector<WeightedEdge> collectUndirectedEdges(AdjacencyList const& adjacency) noexcept(false);
+static std::vector<uint32_t> primImpl(AdjacencyList const& adjacency, std::vector<WeightedEdge> const& edges) noexcept(false);
+static std::vector<uint32_t> kruskalImpl(uint32_t size, std::vector<WeightedEdge> const& edges, unsigned threads) noexcept(false);
+static std::vector<uint32_t> boruvkaImpl(uint32_t size, std::vector<WeightedEdge> const& edges, unsigned threads) noexcept(false);
+
+SpanningForest minimumSpanningForest(Graph const& graph, SpanningTreeAlgorithm algorithm, unsigned threads) noexcept(false)
+{
+    AdjacencyList adjacency{graph};
+    std::vector<WeightedEdge> edges = collectUndirectedEdges(adjacency);
+    uint32_t size = graph.getSize();
+    if (algorithm == SpanningTreeAlgorithm::Auto)
+    {
+        if (static_cast<uint64_t>(edges.size()) * 8 >= static_cast<uint64_t>(size) * size)
+        {
+            algorithm = SpanningTreeAlgorithm::Prim;
+        }
+        else if (edges.size() >= (1U << 20) && Parallel::threadsCount(threads) > 1)
+        {
+            algorithm = SpanningTreeAlgorithm::Boruvka;
+        }
+        else
+        {
+            algorithm = SpanningTreeAlgorithm::Kruskal;
+        }
+    }
+
+    std::vector<uint32_t> chosen;
+    switch (algorithm)
+    {
+    case SpanningTreeAlgorithm::Prim:
+        chosen = primImpl(adjacency, edges);
+        break;
+    case SpanningTreeAlgorithm::Boruvka:
+        chosen = boruvkaImpl(size, edges, threads);
+        break;
+    default:
+        chosen = kruskalImpl(size, edges, threads);
+        break;
+    }
+
+    SpanningForest forest{{}, 0, size - static_cast<uint32_t>(chosen.size())};
+    forest.edges.reserve(chosen.size());
+    for (auto&& index : chosen)
+    {
+        WeightedEdge const& edge = edges[index];
+        forest.edges.push_back(Edge{Node{edge.first}, Node{edge.second}, edge.weight, EdgeDirection::Undirected});
+        forest.totalWeight += edge.weight;
+    }
+    return forest;
+}
+
+SpanningForest minimumSpanningForest(LabeledGraph const& graph, SpanningTreeAlgorithm algorithm, unsigned threads) noexcept(false)
+{
+    return minimumSpanningForest(graph.getRawGraph(), algorithm, threads);
+}
+
+// =====================================================
+//                   IMPLEMENTATION
+// =====================================================
+
+namespace
+{
+
+bool lighter(std::vector<WeightedEdge> const& edges, uint32_t lhs, uint32_t rhs)
+{
+    // Ties are broken by edge index so every algorithm sees the same strict total order.
+    return (edges[lhs].weight != edges[rhs].weight) ? (edges[lhs].weight < edges[rhs].weight) : (lhs < rhs);
+}
+
+edge_weight_type const* findWeight(AdjacencyList const& adjacency, node_type src, node_type target)
+{
+    node_type const* begin = adjacency.targetsBegin(src);
+    node_type const* end = adjacency.targetsEnd(src);
+    node_type const* it = std::lower_bound(begin, end, target);
+    return (it != end && *it == target) ? adjacency.weightsBegin(src) + (it - begin) : nullptr;
+}
+
+}
+
+std::vector<WeightedEdge> collectUndirectedEdges(AdjacencyList const& adjacency) noexcept(false)
+{
+    std::vector<WeightedEdge> edges;
+    edges.reserve(adjacency.getEdgesCount() / 2);
+    for (node_type src = 0; src < adjacency.getSize(); ++src)
+    {
+        edge_weight_type const* weight = adjacency.weightsBegin(src);
+        for (auto it = adjacency.targetsBegin(src); it != adjacency.targetsEnd(src); ++it, ++weight)
+        {
+            edge_weight_type const* reverse = findWeight(adjacency, *it, src);
+            if (src < *it)
+            {
+                edges.push_back(WeightedEdge{src, *it, reverse ? std::min(*weight, *reverse) : *weight});
+            }
+            else if (src > *it && !reverse)
+            {
+                edges.push_back(WeightedEdge{*it, src, *weight});
+            }
+        }
+    }
+    return edges;
+}
+
+std::vector<uint32_t> primImpl(AdjacencyList const& adjacency, std::vector<WeightedEdge> const& edges) noexcept(false)
+{
+    uint32_t size = adjacency.getSize();
+    // Incidence lists (both endpoints) built by counting sort over the undirected edge list.
+    std::vector<std::size_t> offsets(size + 1, 0);
+    for (auto&& edge : edges)
+    {
+        ++offsets[edge.first + 1];
+        ++offsets[edge.second + 1];
+    }
+    for (uint32_t node = 0; node < size; ++node)
+    {
+        offsets[node + 1] += offsets[node];
+    }
+    std::vector<uint32_t> incident(offsets.back());
+    {
+        std::vector<std::size_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (uint32_t index = 0; index < edges.size(); ++index)
+        {
+            incident[cursor[edges[index].first]++] = index;
+            incident[cursor[edges[index].second]++] = index;
+        }
+    }
+
+    auto heavier = [&edges](uint32_t lhs, uint32_t rhs) { return lighter(edges, rhs, lhs); };
+    std::priority_queue<uint32_t, std::vector<uint32_t>, decltype(heavier)> heap(heavier);
+    std::vector<uint8_t> inTree(size, 0);
+    std::vector<uint32_t> chosen;
+    chosen.reserve(size);
+    for (node_type root = 0; root < size; ++root)
+    {
+        if (inTree[root] != 0)
+        {
+            continue;
+        }
+        node_type node = root;
+        while (true)
+        {
+            inTree[node] = 1;
+            for (std::size_t slot = offsets[node]; slot < offsets[node + 1]; ++slot)
+            {
+                WeightedEdge const& edge = edges[incident[slot]];
+                if (inTree[edge.first == node ? edge.second : edge.first] == 0)
+                {
+                    heap.push(incident[slot]);
+                }
+            }
+
+            bool grown = false;
+            while (!heap.empty())
+            {
+                uint32_t index = heap.top();
+                heap.pop();
+                node_type outside = (inTree[edges[index].first] == 0) ? edges[index].first : edges[index].second;
+                if (inTree[outside] == 0)
+                {
+                    chosen.push_back(index);
+                    node = outside;
+                    grown = true;
+                    break;
+                }
+            }
+            if (!grown)
+            {
+                break;
+            }
+        }
+    }
+    return chosen;
+}
+
+std::vector<uint32_t> kruskalImpl(uint32_t size, std::vector<WeightedEdge> const& edges, unsigned threads) noexcept(false)
+{
+    std::vector<uint32_t> order(edges.size());
+    for (uint32_t index = 0; index < edges.size(); ++index)
+    {
+        order[index] = index;
+    }
+    Parallel::sort(order.begin(), order.end(), [&edges](uint32_t lhs, uint32_t rhs) { return lighter(edges, lhs, rhs); }, threads);
+
+    DisjointSets sets{size};
+    std::vector<uint32_t> chosen;
+    chosen.reserve(size);
+    for (auto&& index : order)
+    {
+        if (sets.unite(edges[index].first, edges[index].second))
+        {
+            chosen.push_back(index);
+            if (sets.getSetsCount() == 1)
+            {
+                break;
+            }
+        }
+    }
+    return chosen;
+}
+
+std::vector<uint32_t> boruvkaImpl(uint32_t size, std::vector<WeightedEdge> const& edges, unsigned threads) noexcept(false)
+{
+    // Each round every component picks its lightest incident edge in parallel (atomic min over edge
+    // indices in the total order), the picks are contracted, and edges inside one component are dropped.
+    std::vector<node_type> component(size);
+    for (node_type node = 0; node < size; ++node)
+    {
+        component[node] = node;
+    }
+    std::vector<uint32_t> alive(edges.size());
+    for (uint32_t index = 0; index < edges.size(); ++index)
+    {
+        alive[index] = index;
+    }
+
+    constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+    std::unique_ptr<std::atomic<uint32_t>[]> best(new std::atomic<uint32_t>[size]);
+    DisjointSets sets{size};
+    std::vector<uint32_t> chosen;
+    chosen.reserve(size);
+    while (!alive.empty())
+    {
+        Parallel::forEach(size, threads, [&](unsigned, std::size_t node) { best[node].store(none, std::memory_order_relaxed); }, 4096);
+        Parallel::forEach(alive.size(), threads, [&](unsigned, std::size_t slot)
+        {
+            uint32_t index = alive[slot];
+            for (node_type owner : {component[edges[index].first], component[edges[index].second]})
+            {
+                uint32_t current = best[owner].load(std::memory_order_relaxed);
+                while ((current == none || lighter(edges, index, current))
+                       && !best[owner].compare_exchange_weak(current, index, std::memory_order_relaxed))
+                {
+                }
+            }
+        }, 4096);
+
+        for (node_type node = 0; node < size; ++node)
+        {
+            uint32_t index = best[node].load(std::memory_order_relaxed);
+            if (component[node] == node && index != none && sets.unite(edges[index].first, edges[index].second))
+            {
+                chosen.push_back(index);
+            }
+        }
+
+        for (node_type node = 0; node < size; ++node)
+        {
+            component[node] = sets.find(node);
+        }
+        alive.erase(std::remove_if(alive.begin(), alive.end(), [&](uint32_t index)
+        {
+            return component[edges[index].first] == component[edges[index].second];
+        }), alive.end());
+    }
+    return chosen;
+}
+
+}
+
+}
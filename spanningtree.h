@@ -0,0 +1,42 @@
+#ifndef SPANNINGTREE_H
+#define SPANNINGTREE_H
+
+#include <vector>
+#include "commontypes.hpp"
+
+namespace Graphs
+{
+
+// Forward declaration of Graph class
+class Graph;
+// Forward declaration of LabeledGraph class
+class LabeledGraph;
+
+namespace Algorithms
+{
+
+enum class SpanningTreeAlgorithm : uint8_t
+{
+    Auto,
+    Prim,
+    Kruskal,
+    Boruvka
+};
+
+struct SpanningForest
+{
+    std::vector<Edge> edges;
+    int64_t totalWeight;
+    uint32_t treesCount;
+};
+
+// Minimum spanning forest of the graph taken as undirected; when both directions of an edge exist
+// with different weights the lighter one is used. Disconnected graphs yield one tree per component.
+SpanningForest minimumSpanningForest(Graph const& graph, SpanningTreeAlgorithm algorithm = SpanningTreeAlgorithm::Auto, unsigned threads = 0) noexcept(false);
+SpanningForest minimumSpanningForest(LabeledGraph const& graph, SpanningTreeAlgorithm algorithm = SpanningTreeAlgorithm::Auto, unsigned threads = 0) noexcept(false);
+
+}
+
+}
+
+#endif // SPANNINGTREE_H
@@ -0,0 +1,208 @@
+#include <cstdio>
+#include <stdexcept>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "generators.h"
+#include "graph.h"
+#include "journal.h"
+#include "kshortestpaths.h"
+#include "labeledgraph.h"
+#include "labelindex.h"
+#include "pathcache.h"
+#include "randomwalks.h"
+
+// graphs-tests
+// Regression checks; prints every failure and exits non-zero if there was one.
+
+namespace
+{
+
+int failures = 0;
+
+void check(bool condition, std::string const& what)
+{
+    if (!condition)
+    {
+        std::cerr << "FAILED: " << what << std::endl;
+        ++failures;
+    }
+}
+
+bool hasDuplicates(std::vector<Graphs::Algorithms::WeightedPath> const& routes)
+{
+    for (std::size_t first = 0; first < routes.size(); ++first)
+    {
+        for (std::size_t second = first + 1; second < routes.size(); ++second)
+        {
+            if (routes[first].nodes == routes[second].nodes)
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Every via node of a route used to rebuild and accept that same route when its cost was zero.
+void alternativeRoutesOnZeroWeights()
+{
+    Graphs::Graph graph{5, Graphs::GraphRepresentation::Sparse};
+    graph.insertEdge(0, 1, Graphs::EdgeDirection::Directed);
+    graph.insertEdge(1, 2, Graphs::EdgeDirection::Directed);
+    graph.insertEdge(2, 4, Graphs::EdgeDirection::Directed);
+    graph.insertEdge(0, 3, Graphs::EdgeDirection::Directed);
+    graph.insertEdge(3, 4, Graphs::EdgeDirection::Directed);
+    auto routes = Graphs::Algorithms::alternativeRoutes(graph, Graphs::Node{0}, Graphs::Node{4}, 5);
+    check(routes.size() == 2, "alternativeRoutes on zero weights finds both routes once");
+    check(!hasDuplicates(routes), "alternativeRoutes on zero weights returns distinct routes");
+}
+
+// With maxOverlap = 1 a route overlapping an accepted one completely still passes the overlap test.
+void alternativeRoutesWithFullOverlap()
+{
+    Graphs::Graph graph{4, Graphs::GraphRepresentation::Sparse};
+    for (Graphs::Node::integral_type node = 0; node + 1 < 4; ++node)
+    {
+        graph.insertEdge(node, node + 1, 1, Graphs::EdgeDirection::Directed);
+    }
+    Graphs::Algorithms::AlternativeRoutesOptions options;
+    options.maxOverlap = 1.0;
+    auto routes = Graphs::Algorithms::alternativeRoutes(graph, Graphs::Node{0}, Graphs::Node{3}, 5, options);
+    check(routes.size() == 1, "alternativeRoutes on a chain with maxOverlap = 1 returns the chain once");
+}
+
+// With every label empty the key buffer is empty too and has no data pointer to compare through.
+void labelIndexOnEmptyLabels()
+{
+    Graphs::LabeledGraph graph{4};
+    Graphs::LabelIndex index{graph};
+    check(index.find("").size() == 4, "LabelIndex finds every empty label");
+    check(index.countPrefix("") == 4, "LabelIndex counts every label under the empty prefix");
+    check(index.findPrefix("", 2).size() == 2, "LabelIndex limits prefix results");
+    check(index.findSimilar("ab", 2, 10).size() == 4, "LabelIndex matches empty labels within two edits of \"ab\"");
+    check(index.findPrefix("a").empty(), "LabelIndex finds no label starting with \"a\"");
+}
+
+// Weight times degree used to overflow 32 bits while scaling a hub's alias table, inflating light edges.
+void randomWalksOnHeavyHub()
+{
+    Graphs::Node::integral_type const size = 140000;
+    Graphs::Graph graph{size, Graphs::GraphRepresentation::Sparse};
+    graph.insertEdge(0, 1, 1, Graphs::EdgeDirection::Directed);
+    for (Graphs::Node::integral_type node = 2; node < size; ++node)
+    {
+        graph.insertEdge(0, node, 32000, Graphs::EdgeDirection::Directed);
+    }
+    Graphs::RandomWalkOptions options;
+    options.walkLength = 2;
+    options.weighted = true;
+    Graphs::RandomWalker walker{graph, options};
+    // The light edge has probability about 2.2e-10; the overflow raised it to about 6e-6.
+    uint32_t light = 0;
+    Graphs::Node::integral_type walk[2];
+    for (uint64_t id = 0; id < 1000000; ++id)
+    {
+        walker.walk(0, id, walk);
+        light += walk[1] == 1 ? 1 : 0;
+    }
+    check(light == 0, "RandomWalker samples a light edge of a heavy hub in proportion to its weight");
+}
+
+// Snapshots go through serialize() and fromXml(), which used to read negative weights back as 0.
+void journalCompactionKeepsNegativeWeights()
+{
+    std::string const path = "graphs-tests-journal";
+    std::remove((path + ".snapshot").c_str());
+    std::remove((path + ".journal").c_str());
+    {
+        Graphs::Graph graph{3, Graphs::GraphRepresentation::Sparse};
+        Graphs::GraphJournal journal{path};
+        journal.load(graph);
+        journal.insertEdge(graph, 0, 1, -5, Graphs::EdgeDirection::Directed);
+        journal.insertEdge(graph, 1, 2, 7, Graphs::EdgeDirection::Directed);
+        journal.compact(graph);
+    }
+    Graphs::Graph loaded;
+    Graphs::GraphJournal journal{path};
+    journal.load(loaded);
+    check(loaded.getSize() == 3, "GraphJournal restores the node count from a snapshot");
+    check(loaded.getEdgeWeight(0, 1) == -5, "GraphJournal restores a negative weight from a snapshot");
+    check(loaded.getEdgeWeight(1, 2) == 7, "GraphJournal restores a positive weight from a snapshot");
+    std::remove((path + ".snapshot").c_str());
+    std::remove((path + ".journal").c_str());
+}
+
+// The weight distribution used to be constructed from an inverted range before the range was checked.
+void generatorsRejectInvertedWeights()
+{
+    Graphs::Generators::GeneratorOptions options;
+    options.minWeight = 10;
+    options.maxWeight = 1;
+    bool rejected = false;
+    try
+    {
+        Graphs::Generators::erdosRenyi(16, 8, options);
+    }
+    catch (std::invalid_argument&)
+    {
+        rejected = true;
+    }
+    check(rejected, "Generators reject a minimal weight above the maximal weight");
+}
+
+// Inserting an entry for one graph used to evict every entry of any other graph, referenced or not.
+void pathCacheSharedByTwoGraphs()
+{
+    using Graphs::Node;
+    Graphs::Graph first{5, Graphs::GraphRepresentation::Sparse};
+    Graphs::Graph second{5, Graphs::GraphRepresentation::Sparse};
+    for (Node::integral_type node = 0; node + 1 < 5; ++node)
+    {
+        first.insertEdge(node, node + 1, 1, Graphs::EdgeDirection::Directed);
+        second.insertEdge(node, node + 1, 1, Graphs::EdgeDirection::Directed);
+    }
+    Graphs::PathCache cache{4, 1};
+    for (Node::integral_type target = 1; target < 5; ++target)
+    {
+        cache.isReachable(first, Node{0}, Node{target});
+    }
+    cache.isReachable(first, Node{0}, Node{1});
+    cache.isReachable(first, Node{0}, Node{2});
+    cache.isReachable(second, Node{0}, Node{1});
+    cache.resetStatistics();
+    cache.isReachable(first, Node{0}, Node{1});
+    cache.isReachable(first, Node{0}, Node{2});
+    check(cache.getStatistics().hits == 2, "PathCache keeps referenced entries of a graph while caching another one");
+
+    // A mutation outdates every entry of the graph, so they go first whatever their reference bit.
+    first.insertEdge(4, 0, 1, Graphs::EdgeDirection::Directed);
+    for (Node::integral_type target = 1; target < 4; ++target)
+    {
+        cache.isReachable(first, Node{4}, Node{target});
+    }
+    cache.resetStatistics();
+    cache.isReachable(second, Node{0}, Node{1});
+    check(cache.getStatistics().hits == 1, "PathCache evicts outdated entries before live ones");
+}
+
+}
+
+int main()
+{
+    alternativeRoutesOnZeroWeights();
+    alternativeRoutesWithFullOverlap();
+    labelIndexOnEmptyLabels();
+    randomWalksOnHeavyHub();
+    journalCompactionKeepsNegativeWeights();
+    generatorsRejectInvertedWeights();
+    pathCacheSharedByTwoGraphs();
+    if (failures != 0)
+    {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,9 @@
+TEMPLATE = app
+TARGET = graphs-tests
+CONFIG += console c++14 qt thread
+CONFIG -= app_bundle
+QT+=xml
+
+include(graphs.pri)
+
+SOURCES += tests.cpp
@@ -0,0 +1,114 @@
+#include "threadpool.h"
+#include "parallel.h"
+
+namespace Graphs
+{
+
+namespace
+{
+
+// Lets tasks submitted from inside a worker land on that worker's own deque.
+thread_local ThreadPool const* currentPool = nullptr;
+thread_local unsigned currentWorker = 0;
+
+}
+
+ThreadPool::ThreadPool(unsigned threads) : m_workers(), m_threads(), m_pending(0), m_nextWorker(0), m_sleepMutex(), m_wake(),
+                                           m_stopping(false)
+{
+    unsigned count = Parallel::threadsCount(threads);
+    for (unsigned index = 0; index < count; ++index)
+    {
+        m_workers.emplace_back(new Worker);
+    }
+    for (unsigned index = 0; index < count; ++index)
+    {
+        m_threads.emplace_back(&ThreadPool::run, this, index);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (auto&& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+unsigned ThreadPool::getSize() const noexcept
+{
+    return static_cast<unsigned>(m_workers.size());
+}
+
+void ThreadPool::submit(task_type task)
+{
+    unsigned index = (currentPool == this) ? currentWorker
+                                           : m_nextWorker.fetch_add(1, std::memory_order_relaxed) % getSize();
+    {
+        // Counted under the deque lock, so no worker can pop and decrement the task before it is counted.
+        std::lock_guard<std::mutex> lock(m_workers[index]->mutex);
+        m_pending.fetch_add(1, std::memory_order_release);
+        m_workers[index]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+    }
+    m_wake.notify_one();
+}
+
+bool ThreadPool::tryPop(unsigned index, task_type& task)
+{
+    {
+        Worker& own = *m_workers[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty())
+        {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (unsigned offset = 1; offset < getSize(); ++offset)
+    {
+        Worker& victim = *m_workers[(index + offset) % getSize()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::run(unsigned index)
+{
+    currentPool = this;
+    currentWorker = index;
+    task_type task;
+    while (true)
+    {
+        if (tryPop(index, task))
+        {
+            m_pending.fetch_sub(1, std::memory_order_acq_rel);
+            task(index);
+            task = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_wake.wait(lock, [this] { return m_stopping || m_pending.load(std::memory_order_acquire) != 0; });
+        if (m_stopping && m_pending.load(std::memory_order_acquire) == 0)
+        {
+            break;
+        }
+    }
+}
+
+}
@@ -0,0 +1,69 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Graphs
+{
+
+// Fixed-size work-stealing pool. Each worker owns a deque: it pops its own newest task and steals
+// the oldest ones of others when idle. Tasks receive the index of the worker running them so they
+// can use per-worker state without synchronization.
+class ThreadPool
+{
+public:
+    using task_type = std::function<void(unsigned)>;
+
+private:
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<task_type> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::vector<std::thread> m_threads;
+    std::atomic<std::size_t> m_pending;
+    std::atomic<unsigned> m_nextWorker;
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;
+    bool m_stopping;
+
+    void run(unsigned index);
+    bool tryPop(unsigned index, task_type& task);
+
+public:
+    explicit ThreadPool(unsigned threads = 0);
+    ThreadPool(ThreadPool const&) = delete;
+    ThreadPool(ThreadPool&&) = delete;
+    ThreadPool& operator=(ThreadPool const&) = delete;
+    ThreadPool& operator=(ThreadPool&&) = delete;
+    ~ThreadPool();
+
+    unsigned getSize() const noexcept;
+
+    // Tasks given to submit() must not throw; async() carries exceptions through the future.
+    void submit(task_type task);
+
+    template <typename Function>
+    auto async(Function&& function) -> std::future<decltype(function(0U))>
+    {
+        using result_type = decltype(function(0U));
+        auto task = std::make_shared<std::packaged_task<result_type(unsigned)>>(std::forward<Function>(function));
+        std::future<result_type> future = task->get_future();
+        submit([task](unsigned worker) { (*task)(worker); });
+        return future;
+    }
+};
+
+}
+
+#endif // THREADPOOL_H
@@ -0,0 +1,285 @@
+#include "triangles.h"
+#include "adjacencylist.h"
+#include "graph.h"
+#include "labeledgraph.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace Graphs
+{
+
+namespace Algorithms
+{
+
+static TriangleStatistics countTrianglesImpl(AdjacencyList const& undirected, TriangleKernel kernel, unsigned threads) noexcept(false);
+
+TriangleStatistics countTriangles(Graph const& graph, TriangleKernel kernel, unsigned threads) noexcept(false)
+{
+    return countTrianglesImpl(AdjacencyList{graph}.symmetrized(), kernel, threads);
+}
+
+TriangleStatistics countTriangles(LabeledGraph const& graph, TriangleKernel kernel, unsigned threads) noexcept(false)
+{
+    return countTriangles(graph.getRawGraph(), kernel, threads);
+}
+
+// =====================================================
+//                   IMPLEMENTATION
+// =====================================================
+
+namespace
+{
+
+using node_type = Node::integral_type;
+
+// Every undirected edge is kept once, pointing from the lower to the higher (degree, id) rank,
+// which bounds forward lists by O(sqrt(E)) and counts each triangle exactly once.
+struct ForwardGraph
+{
+    std::vector<std::size_t> offsets;
+    std::vector<node_type> targets;
+};
+
+ForwardGraph orientByDegree(AdjacencyList const& undirected)
+{
+    uint32_t size = undirected.getSize();
+    std::vector<node_type> rank(size);
+    {
+        std::vector<node_type> order(size);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&undirected](node_type lhs, node_type rhs)
+        {
+            uint32_t l = undirected.getDegree(lhs);
+            uint32_t r = undirected.getDegree(rhs);
+            return (l != r) ? (l < r) : (lhs < rhs);
+        });
+        for (node_type i = 0; i < size; ++i)
+        {
+            rank[order[i]] = i;
+        }
+    }
+
+    ForwardGraph forward;
+    forward.offsets.reserve(size + 1);
+    forward.offsets.push_back(0);
+    forward.targets.reserve(undirected.getEdgesCount() / 2);
+    for (node_type node = 0; node < size; ++node)
+    {
+        for (auto it = undirected.targetsBegin(node); it != undirected.targetsEnd(node); ++it)
+        {
+            if (rank[node] < rank[*it])
+            {
+                forward.targets.push_back(*it);
+            }
+        }
+        forward.offsets.push_back(forward.targets.size());
+    }
+    return forward;
+}
+
+template <typename Visitor>
+void intersectScalar(node_type const* a, node_type const* aEnd, node_type const* b, node_type const* bEnd, Visitor&& visit)
+{
+    while (a != aEnd && b != bEnd)
+    {
+        if (*a < *b)
+        {
+            ++a;
+        }
+        else if (*b < *a)
+        {
+            ++b;
+        }
+        else
+        {
+            visit(*a);
+            ++a;
+            ++b;
+        }
+    }
+}
+
+#if defined(__SSE2__)
+// Block-wise merge: four ids of `a` are compared against all four rotations of a block of `b`,
+// then whichever block has the smaller maximum is advanced.
+template <typename Visitor>
+void intersect(node_type const* a, node_type const* aEnd, node_type const* b, node_type const* bEnd, Visitor&& visit)
+{
+    while (aEnd - a >= 4 && bEnd - b >= 4)
+    {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<__m128i const*>(a));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<__m128i const*>(b));
+        __m128i eq = _mm_cmpeq_epi32(va, vb);
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1))));
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))));
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3))));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(eq));
+        for (int lane = 0; mask != 0; ++lane, mask >>= 1)
+        {
+            if (mask & 1)
+            {
+                visit(a[lane]);
+            }
+        }
+        node_type aMax = a[3];
+        node_type bMax = b[3];
+        if (aMax <= bMax)
+        {
+            a += 4;
+        }
+        if (bMax <= aMax)
+        {
+            b += 4;
+        }
+    }
+    intersectScalar(a, aEnd, b, bEnd, visit);
+}
+#else
+template <typename Visitor>
+void intersect(node_type const* a, node_type const* aEnd, node_type const* b, node_type const* bEnd, Visitor&& visit)
+{
+    intersectScalar(a, aEnd, b, bEnd, visit);
+}
+#endif
+
+// Dense graphs: forward lists as bit rows, intersected a word at a time.
+struct ForwardBitmap
+{
+    std::size_t words;
+    std::vector<uint64_t> bits;
+
+    explicit ForwardBitmap(ForwardGraph const& forward, uint32_t size) : words((size + 63) / 64), bits()
+    {
+        bits.assign(words * size, 0);
+        for (node_type node = 0; node < size; ++node)
+        {
+            for (std::size_t edge = forward.offsets[node]; edge < forward.offsets[node + 1]; ++edge)
+            {
+                node_type target = forward.targets[edge];
+                bits[node * words + target / 64] |= (uint64_t{1} << (target % 64));
+            }
+        }
+    }
+};
+
+inline unsigned trailingZeros(uint64_t word)
+{
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_ctzll(word));
+#else
+    unsigned count = 0;
+    while ((word & 1) == 0)
+    {
+        word >>= 1;
+        ++count;
+    }
+    return count;
+#endif
+}
+
+bool preferBitmap(AdjacencyList const& undirected)
+{
+    // Bit rows cost V^2 / 8 bytes; worth it only when the graph is both small enough and dense.
+    uint64_t size = undirected.getSize();
+    return size <= 65536 && undirected.getEdgesCount() * 16 >= size * size;
+}
+
+}
+
+TriangleStatistics countTrianglesImpl(AdjacencyList const& undirected, TriangleKernel kernel, unsigned threads) noexcept(false)
+{
+    uint32_t size = undirected.getSize();
+    ForwardGraph forward = orientByDegree(undirected);
+    if (kernel == TriangleKernel::Auto)
+    {
+        kernel = preferBitmap(undirected) ? TriangleKernel::Bitmap : TriangleKernel::Merge;
+    }
+    std::unique_ptr<ForwardBitmap> bitmap;
+    if (kernel == TriangleKernel::Bitmap)
+    {
+        bitmap.reset(new ForwardBitmap(forward, size));
+    }
+
+    unsigned workers = Parallel::threadsCount(threads);
+    std::vector<std::vector<uint64_t>> counts(workers);
+    Parallel::forEach(size, workers, [&](unsigned worker, std::size_t index)
+    {
+        std::vector<uint64_t>& local = counts[worker];
+        if (local.empty())
+        {
+            local.assign(size, 0);
+        }
+        node_type u = static_cast<node_type>(index);
+        node_type const* uBegin = forward.targets.data() + forward.offsets[u];
+        node_type const* uEnd = forward.targets.data() + forward.offsets[u + 1];
+        for (node_type const* v = uBegin; v != uEnd; ++v)
+        {
+            uint64_t found = 0;
+            auto visit = [&local, &found](node_type w)
+            {
+                ++local[w];
+                ++found;
+            };
+            if (bitmap)
+            {
+                uint64_t const* uRow = bitmap->bits.data() + u * bitmap->words;
+                uint64_t const* vRow = bitmap->bits.data() + *v * bitmap->words;
+                for (std::size_t word = 0; word < bitmap->words; ++word)
+                {
+                    for (uint64_t common = uRow[word] & vRow[word]; common != 0; common &= common - 1)
+                    {
+                        visit(static_cast<node_type>(word * 64 + trailingZeros(common)));
+                    }
+                }
+            }
+            else
+            {
+                intersect(uBegin, uEnd, forward.targets.data() + forward.offsets[*v],
+                          forward.targets.data() + forward.offsets[*v + 1], visit);
+            }
+            local[u] += found;
+            local[*v] += found;
+        }
+    }, 256);
+
+    TriangleStatistics statistics{0, std::vector<uint64_t>(size, 0), std::vector<double>(size, 0.0), 0.0, 0.0};
+    for (auto&& local : counts)
+    {
+        for (node_type node = 0; node < size && !local.empty(); ++node)
+        {
+            statistics.nodeTriangles[node] += local[node];
+        }
+    }
+
+    uint64_t wedges = 0;
+    uint64_t cornerSum = 0;
+    double clusteringSum = 0.0;
+    for (node_type node = 0; node < size; ++node)
+    {
+        uint64_t degree = undirected.getDegree(node);
+        uint64_t nodeWedges = degree * (degree - (degree > 0 ? 1 : 0)) / 2;
+        wedges += nodeWedges;
+        cornerSum += statistics.nodeTriangles[node];
+        if (nodeWedges != 0)
+        {
+            statistics.localClustering[node] = static_cast<double>(statistics.nodeTriangles[node]) / nodeWedges;
+        }
+        clusteringSum += statistics.localClustering[node];
+    }
+    statistics.triangles = cornerSum / 3;
+    statistics.averageClustering = (size != 0) ? clusteringSum / size : 0.0;
+    statistics.transitivity = (wedges != 0) ? static_cast<double>(cornerSum) / wedges : 0.0;
+    return statistics;
+}
+
+}
+
+}
@@ -0,0 +1,42 @@
+#ifndef TRIANGLES_H
+#define TRIANGLES_H
+
+#include <vector>
+#include "commontypes.hpp"
+
+namespace Graphs
+{
+
+// Forward declaration of Graph class
+class Graph;
+// Forward declaration of LabeledGraph class
+class LabeledGraph;
+
+namespace Algorithms
+{
+
+enum class TriangleKernel : uint8_t
+{
+    Auto,
+    Merge,
+    Bitmap
+};
+
+// Edges are taken as undirected (u ~ v if either direction exists) and self loops are ignored.
+struct TriangleStatistics
+{
+    uint64_t triangles;
+    std::vector<uint64_t> nodeTriangles;
+    std::vector<double> localClustering;
+    double averageClustering;
+    double transitivity;
+};
+
+TriangleStatistics countTriangles(Graph const& graph, TriangleKernel kernel = TriangleKernel::Auto, unsigned threads = 0) noexcept(false);
+TriangleStatistics countTriangles(LabeledGraph const& graph, TriangleKernel kernel = TriangleKernel::Auto, unsigned threads = 0) noexcept(false);
+
+}
+
+}
+
+#endif // TRIANGLES_H
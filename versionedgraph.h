@@ -0,0 +1,239 @@
+#ifndef VERSIONEDGRAPH_H
+#define VERSIONEDGRAPH_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Graphs
+{
+
+// Copy-on-write publication of immutable graph versions (Graph or LabeledGraph).
+//
+// Readers call acquire() and get a Snapshot pinning the current version. Acquiring is lock-free:
+// the reader claims a slot, announces the global epoch in it, then loads the version pointer.
+// Writers are serialized by a mutex. They build the next version off to the side, swap the
+// pointer and retire the old version with the epoch at which it was unlinked. A retired version
+// is freed once no busy slot announces an epoch at or below its retire epoch.
+//
+// Snapshots must be released before the VersionedGraph is destroyed.
+template <typename GraphType>
+class VersionedGraph
+{
+private:
+    struct Version
+    {
+        GraphType graph;
+        uint64_t number;
+    };
+
+    // Padded to a cache line so readers on different slots do not false-share.
+    struct ReaderSlot
+    {
+        std::atomic<uint64_t> epoch;
+        std::atomic<bool> busy;
+        char padding[64 - sizeof(std::atomic<uint64_t>) - sizeof(std::atomic<bool>)];
+    };
+
+    struct Retired
+    {
+        std::unique_ptr<Version const> version;
+        uint64_t epoch;
+    };
+
+    static constexpr std::size_t readerSlots = 256;
+    static constexpr uint64_t idle = UINT64_MAX;
+
+    std::atomic<Version const*> m_current;
+    std::atomic<uint64_t> m_epoch;
+    std::unique_ptr<ReaderSlot[]> m_slots;
+    std::mutex m_writerMutex;
+    std::vector<Retired> m_retired;
+
+    std::size_t claimSlot() const noexcept
+    {
+        static thread_local std::size_t hint = std::hash<std::thread::id>()(std::this_thread::get_id());
+        for (std::size_t probe = 0; ; ++probe)
+        {
+            std::size_t index = (hint + probe) % readerSlots;
+            bool expected = false;
+            if (!m_slots[index].busy.load(std::memory_order_relaxed)
+                    && m_slots[index].busy.compare_exchange_strong(expected, true, std::memory_order_acquire))
+            {
+                hint = index;
+                return index;
+            }
+            if (probe % readerSlots == readerSlots - 1)
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    uint64_t oldestReaderEpoch() const noexcept
+    {
+        uint64_t oldest = idle;
+        for (std::size_t index = 0; index < readerSlots; ++index)
+        {
+            uint64_t epoch = m_slots[index].epoch.load(std::memory_order_seq_cst);
+            oldest = (epoch < oldest) ? epoch : oldest;
+        }
+        return oldest;
+    }
+
+    // Requires m_writerMutex.
+    void reclaim()
+    {
+        uint64_t oldest = oldestReaderEpoch();
+        auto kept = m_retired.begin();
+        for (auto it = m_retired.begin(); it != m_retired.end(); ++it)
+        {
+            if (it->epoch >= oldest)
+            {
+                *kept++ = std::move(*it);
+            }
+        }
+        m_retired.erase(kept, m_retired.end());
+    }
+
+    // Requires m_writerMutex.
+    uint64_t install(GraphType&& next)
+    {
+        Version const* previous = m_current.load(std::memory_order_relaxed);
+        uint64_t number = previous->number + 1;
+        Version const* created = new Version{std::move(next), number};
+        m_current.exchange(created, std::memory_order_seq_cst);
+        uint64_t retireEpoch = m_epoch.fetch_add(1, std::memory_order_seq_cst);
+        m_retired.push_back(Retired{std::unique_ptr<Version const>(previous), retireEpoch});
+        reclaim();
+        return number;
+    }
+
+public:
+    class Snapshot
+    {
+        friend class VersionedGraph;
+
+    private:
+        VersionedGraph const* m_owner;
+        Version const* m_version;
+        std::size_t m_slot;
+
+        Snapshot(VersionedGraph const* owner, Version const* version, std::size_t slot) noexcept
+            : m_owner(owner), m_version(version), m_slot(slot) { }
+
+        void release() noexcept
+        {
+            if (m_owner != nullptr)
+            {
+                m_owner->m_slots[m_slot].epoch.store(idle, std::memory_order_release);
+                m_owner->m_slots[m_slot].busy.store(false, std::memory_order_release);
+                m_owner = nullptr;
+            }
+        }
+
+    public:
+        Snapshot(Snapshot const&) = delete;
+        Snapshot& operator=(Snapshot const&) = delete;
+        Snapshot(Snapshot&& other) noexcept : m_owner(other.m_owner), m_version(other.m_version), m_slot(other.m_slot)
+        {
+            other.m_owner = nullptr;
+        }
+        Snapshot& operator=(Snapshot&& other) noexcept
+        {
+            if (this != &other)
+            {
+                release();
+                m_owner = other.m_owner;
+                m_version = other.m_version;
+                m_slot = other.m_slot;
+                other.m_owner = nullptr;
+            }
+            return *this;
+        }
+        ~Snapshot()
+        {
+            release();
+        }
+
+        GraphType const& graph() const noexcept { return m_version->graph; }
+        GraphType const& operator*() const noexcept { return m_version->graph; }
+        GraphType const* operator->() const noexcept { return &m_version->graph; }
+        uint64_t version() const noexcept { return m_version->number; }
+    };
+
+    explicit VersionedGraph(GraphType initial = GraphType{})
+        : m_current(new Version{std::move(initial), 0}), m_epoch(0), m_slots(new ReaderSlot[readerSlots]), m_writerMutex(), m_retired()
+    {
+        for (std::size_t index = 0; index < readerSlots; ++index)
+        {
+            m_slots[index].epoch.store(idle, std::memory_order_relaxed);
+            m_slots[index].busy.store(false, std::memory_order_relaxed);
+        }
+    }
+    VersionedGraph(VersionedGraph const&) = delete;
+    VersionedGraph(VersionedGraph&&) = delete;
+    VersionedGraph& operator=(VersionedGraph const&) = delete;
+    VersionedGraph& operator=(VersionedGraph&&) = delete;
+    ~VersionedGraph()
+    {
+        delete m_current.load(std::memory_order_acquire);
+    }
+
+    Snapshot acquire() const noexcept
+    {
+        std::size_t slot = claimSlot();
+        m_slots[slot].epoch.store(m_epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+        Version const* version = m_current.load(std::memory_order_seq_cst);
+        return Snapshot{this, version, slot};
+    }
+
+    uint64_t currentVersion() const noexcept
+    {
+        return m_current.load(std::memory_order_acquire)->number;
+    }
+
+    // Copies the current version, applies `mutation` to the copy and publishes it; returns the new version number.
+    template <typename Mutation>
+    uint64_t update(Mutation&& mutation) noexcept(false)
+    {
+        std::lock_guard<std::mutex> lock(m_writerMutex);
+        GraphType next = m_current.load(std::memory_order_relaxed)->graph;
+        mutation(next);
+        return install(std::move(next));
+    }
+
+    uint64_t publish(GraphType next) noexcept(false)
+    {
+        std::lock_guard<std::mutex> lock(m_writerMutex);
+        return install(std::move(next));
+    }
+
+    // Frees retired versions no reader can still see; also runs after every publication.
+    void collect()
+    {
+        std::lock_guard<std::mutex> lock(m_writerMutex);
+        reclaim();
+    }
+
+    std::size_t retiredCount()
+    {
+        std::lock_guard<std::mutex> lock(m_writerMutex);
+        return m_retired.size();
+    }
+};
+
+template <typename GraphType>
+constexpr std::size_t VersionedGraph<GraphType>::readerSlots;
+
+template <typename GraphType>
+constexpr uint64_t VersionedGraph<GraphType>::idle;
+
+}
+
+#endif // VERSIONEDGRAPH_H